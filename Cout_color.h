@@ -1,90 +1,138 @@
-
-/// ----------------------------------------
-///  Cout colors
-///  Coded by JP CHAMPEAUX
-///  contact : JPC@irsamc.upse-tlse.fr
-///  Free of use for Academic purpose only
-///  (please, just mention author in your works if used or if your own code is inspired from it)
-/// ----------------------------------------
-
-#include <windows.h>
-#include <math.h>
-#include <time.h>
-
-//#define UCHAR_MAX 256
-using namespace std;
-
-/// POUR FAIRE JOLI -----------------------------------
-inline std::ostream& blue(std::ostream &s)
-{
-    HANDLE hStdout = GetStdHandle(STD_OUTPUT_HANDLE);
-    SetConsoleTextAttribute(hStdout,
-        FOREGROUND_BLUE | FOREGROUND_GREEN | FOREGROUND_INTENSITY);
-    return s;
-}
-
-inline std::ostream& red(std::ostream &s)
-{
-    HANDLE hStdout = GetStdHandle(STD_OUTPUT_HANDLE);
-    SetConsoleTextAttribute(hStdout,
-        FOREGROUND_RED | FOREGROUND_INTENSITY);
-    return s;
-}
-
-inline std::ostream& green(std::ostream &s)
-{
-    HANDLE hStdout = GetStdHandle(STD_OUTPUT_HANDLE);
-    SetConsoleTextAttribute(hStdout,
-        FOREGROUND_GREEN | FOREGROUND_INTENSITY);
-    return s;
-}
-
-inline std::ostream& white(std::ostream &s)
-{
-    HANDLE hStdout = GetStdHandle(STD_OUTPUT_HANDLE);
-    SetConsoleTextAttribute(hStdout,
-        FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
-    return s;
-}
-
-// Couleur Jaune
-inline std::ostream& yellow(std::ostream &s)
-{
-    HANDLE hStdout = GetStdHandle(STD_OUTPUT_HANDLE);
-    SetConsoleTextAttribute(hStdout,
-        FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_INTENSITY);
-    return s;
-}
-
-// Couleur Cyan
-inline std::ostream& cyan(std::ostream &s)
-{
-    HANDLE hStdout = GetStdHandle(STD_OUTPUT_HANDLE);
-    SetConsoleTextAttribute(hStdout,
-        FOREGROUND_GREEN | FOREGROUND_BLUE | FOREGROUND_INTENSITY);
-    return s;
-}
-
-// Couleur Magenta (violet)
-inline std::ostream& magenta(std::ostream &s)
-{
-    HANDLE hStdout = GetStdHandle(STD_OUTPUT_HANDLE);
-    SetConsoleTextAttribute(hStdout,
-        FOREGROUND_RED | FOREGROUND_BLUE | FOREGROUND_INTENSITY);
-    return s;
-}
-
-// Couleur grise (low intensity)
-inline std::ostream& grey(std::ostream &s)
-{
-    HANDLE hStdout = GetStdHandle(STD_OUTPUT_HANDLE);
-    SetConsoleTextAttribute(hStdout,
-        FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
-    return s;
-}
-
-struct color {
-    color(WORD attribute) : m_color(attribute) {};
-    WORD m_color;
-};
-/// -----------------------------------------------------
+/// ----------------------------------------
+///  Cout colors
+///  Coded by JP CHAMPEAUX
+///  contact : JPC@irsamc.upse-tlse.fr
+///  Free of use for Academic purpose only
+///  (please, just mention author in your works if used or if your own code is inspired from it)
+/// ----------------------------------------
+
+#ifndef COUT_COLOR_H_INCLUDED
+#define COUT_COLOR_H_INCLUDED
+
+#include <math.h>
+#include <time.h>
+#include <iostream>
+
+//#define UCHAR_MAX 256
+using namespace std;
+
+#ifdef _WIN32
+
+#include <windows.h>
+
+/// POUR FAIRE JOLI -----------------------------------
+inline std::ostream& blue(std::ostream &s)
+{
+    HANDLE hStdout = GetStdHandle(STD_OUTPUT_HANDLE);
+    SetConsoleTextAttribute(hStdout,
+        FOREGROUND_BLUE | FOREGROUND_GREEN | FOREGROUND_INTENSITY);
+    return s;
+}
+
+inline std::ostream& red(std::ostream &s)
+{
+    HANDLE hStdout = GetStdHandle(STD_OUTPUT_HANDLE);
+    SetConsoleTextAttribute(hStdout,
+        FOREGROUND_RED | FOREGROUND_INTENSITY);
+    return s;
+}
+
+inline std::ostream& green(std::ostream &s)
+{
+    HANDLE hStdout = GetStdHandle(STD_OUTPUT_HANDLE);
+    SetConsoleTextAttribute(hStdout,
+        FOREGROUND_GREEN | FOREGROUND_INTENSITY);
+    return s;
+}
+
+inline std::ostream& white(std::ostream &s)
+{
+    HANDLE hStdout = GetStdHandle(STD_OUTPUT_HANDLE);
+    SetConsoleTextAttribute(hStdout,
+        FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
+    return s;
+}
+
+// Couleur Jaune
+inline std::ostream& yellow(std::ostream &s)
+{
+    HANDLE hStdout = GetStdHandle(STD_OUTPUT_HANDLE);
+    SetConsoleTextAttribute(hStdout,
+        FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_INTENSITY);
+    return s;
+}
+
+// Couleur Cyan
+inline std::ostream& cyan(std::ostream &s)
+{
+    HANDLE hStdout = GetStdHandle(STD_OUTPUT_HANDLE);
+    SetConsoleTextAttribute(hStdout,
+        FOREGROUND_GREEN | FOREGROUND_BLUE | FOREGROUND_INTENSITY);
+    return s;
+}
+
+// Couleur Magenta (violet)
+inline std::ostream& magenta(std::ostream &s)
+{
+    HANDLE hStdout = GetStdHandle(STD_OUTPUT_HANDLE);
+    SetConsoleTextAttribute(hStdout,
+        FOREGROUND_RED | FOREGROUND_BLUE | FOREGROUND_INTENSITY);
+    return s;
+}
+
+// Couleur grise (low intensity)
+inline std::ostream& grey(std::ostream &s)
+{
+    HANDLE hStdout = GetStdHandle(STD_OUTPUT_HANDLE);
+    SetConsoleTextAttribute(hStdout,
+        FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
+    return s;
+}
+
+struct color {
+    color(WORD attribute) : m_color(attribute) {};
+    WORD m_color;
+};
+
+#else
+
+/// Terminaux POSIX : séquences ANSI, seulement si le flux écrit dans un terminal
+/// (cout : sortie standard ; cerr, clog : erreur standard ; rien dans un fichier ou un pipe)
+#include <unistd.h>
+
+inline std::ostream& ansi_color(std::ostream &s, const char* code)
+{
+    static const bool out_tty = isatty(STDOUT_FILENO) != 0;
+    static const bool err_tty = isatty(STDERR_FILENO) != 0;
+    if ((&s == &std::cout && out_tty) || ((&s == &std::cerr || &s == &std::clog) && err_tty))
+        s << code;
+    return s;
+}
+
+/// POUR FAIRE JOLI -----------------------------------
+inline std::ostream& blue(std::ostream &s)    { return ansi_color(s, "\033[96m"); }
+inline std::ostream& red(std::ostream &s)     { return ansi_color(s, "\033[91m"); }
+inline std::ostream& green(std::ostream &s)   { return ansi_color(s, "\033[92m"); }
+inline std::ostream& white(std::ostream &s)   { return ansi_color(s, "\033[0m"); }
+
+// Couleur Jaune
+inline std::ostream& yellow(std::ostream &s)  { return ansi_color(s, "\033[93m"); }
+
+// Couleur Cyan
+inline std::ostream& cyan(std::ostream &s)    { return ansi_color(s, "\033[96m"); }
+
+// Couleur Magenta (violet)
+inline std::ostream& magenta(std::ostream &s) { return ansi_color(s, "\033[95m"); }
+
+// Couleur grise (low intensity)
+inline std::ostream& grey(std::ostream &s)    { return ansi_color(s, "\033[37m"); }
+
+struct color {
+    color(unsigned short attribute) : m_color(attribute) {};
+    unsigned short m_color;
+};
+
+#endif
+/// -----------------------------------------------------
+
+#endif // COUT_COLOR_H_INCLUDED
@@ -1,707 +1,3165 @@
-///  -------------------------------------------------
-///  Tensor Class 14/04/2024 optimisation ...
-///  StandAlone class for Tensor operations
-///  Coded by JP CHAMPEAUX
-///  contact : JPC@irsamc.upse-tlse.fr
-///  Free of use for Academic purpose only !
-///  (please, just mention author in your works if used or if your own code is inspired from it)
-///  CLASS Tensor
-///  --------------------------------------------------
-
-
-#ifndef TENSEURS_H_INCLUDED
-#define TENSEURS_H_INCLUDED
-
-#include <vector>
-#include <iostream>
-#include <numeric>
-#include <stdexcept>
-#include <cmath>
-#include <tuple>
-#include <algorithm>
-
-using namespace std;
-
-template<typename T>
-class Tensor
-{
-private:
-    vector<T> data;
-    vector<size_t> shape;
-    vector<size_t> strides;
-    Tensor<T>* metric = nullptr;  // 🔥 pointeur vers tenseur métrique
-
-    void check_shape_match(const Tensor& other) const
-    {
-        if (shape != other.shape) throw runtime_error("Shape mismatch in operation");
-    }
-
-
-    void slice_data(const vector<pair<size_t, size_t>>& slice_ranges, Tensor<T>& result) const
-    {
-        vector<size_t> idx(shape.size(), 0);
-        vector<size_t> idx_result(shape.size(), 0);
-        for (size_t i = 0; i < data.size(); ++i)
-        {
-            size_t tmp = i;
-            bool in_slice = true;
-            for (int d = 0; d < shape.size(); ++d)
-            {
-                idx[d] = tmp / strides[d];
-                tmp %= strides[d];
-                auto [start, end] = slice_ranges[d];
-                if (idx[d] < start || idx[d] >= end)
-                {
-                    in_slice = false;
-                    break;
-                }
-            }
-
-            if (in_slice)
-            {
-                for (size_t d = 0; d < shape.size(); ++d)
-                    idx_result[d] = idx[d] - slice_ranges[d].first;
-                result(idx_result) = data[i];
-            }
-        }
-    }
-    void compute_strides()
-    {
-        strides.resize(shape.size());
-        size_t stride = 1;
-        for (int i = shape.size() - 1; i >= 0; --i)
-        {
-            strides[i] = stride;
-            stride *= shape[i];
-        }
-    }
-
-    size_t flatten_index(const vector<size_t>& indices) const
-    {
-        if (indices.size() != shape.size())
-            throw runtime_error("Index dimension mismatch");
-
-        size_t idx = 0;
-        for (size_t i = 0; i < shape.size(); ++i)
-        {
-            if (indices[i] >= shape[i])
-                throw out_of_range("Index out of bounds");
-            idx += indices[i] * strides[i];
-        }
-        return idx;
-    }
-
-
-public:
-    Tensor() = default;
-
-    Tensor(const vector<size_t>& shape_, T init_val = T())
-        : shape(shape_)
-    {
-        size_t total = 1;
-        for (auto d : shape) total *= d;
-        data.resize(total, init_val);
-        compute_strides();
-    }
-
-    // Constructeur par liste d'initialisation
-    Tensor(std::initializer_list<size_t> shape_, T init_val = T())
-        : shape(shape_)
-    {
-        size_t total = 1;
-        for (auto d : shape) total *= d;
-        data.resize(total, init_val);
-        compute_strides();
-    }
-
-    // Constructeur avec form
-
-    Tensor(const vector<size_t>& shape_, const vector<T>& values)
-        : shape(shape_), data(values)
-    {
-        size_t total = 1;
-        for (auto d : shape) total *= d;
-        if (data.size() != total)
-            throw std::runtime_error("Data size does not match shape");
-
-        compute_strides();
-    }
-
-    Tensor(const Tensor& other)
-        : data(other.data), shape(other.shape), strides(other.strides)
-    {
-        if (other.metric)
-            metric = new Tensor(*other.metric);
-        else
-            metric = nullptr;
-    }
-
-    Tensor(Tensor<T>&& other) noexcept
-        : data(std::move(other.data)), shape(std::move(other.shape)), strides(std::move(other.strides)), metric(other.metric)
-    {
-        other.metric = nullptr;
-    }
-
-
-    ~Tensor()
-    {
-        if (metric)
-            delete metric;
-    }
-
-    // Surcharge de l'opérateur << pour afficher le tenseur
-    friend ostream& operator<<(ostream& os, const Tensor<T>& tensor)
-    {
-        os << "Tensor (shape: ";
-        for (size_t i = 0; i < tensor.shape.size(); ++i)
-        {
-            os << tensor.shape[i];
-            if (i != tensor.shape.size() - 1) os << " x ";
-        }
-        os << "):\n";
-
-        size_t total = tensor.size();
-        for (size_t i = 0; i < total; ++i)
-        {
-            vector<size_t> indices = tensor.flatten_to_indices(i, tensor.shape);
-            os << "(";
-            for (size_t j = 0; j < indices.size(); ++j)
-            {
-                os << indices[j];
-                if (j != indices.size() - 1) os << ", ";
-            }
-            os << ") = " << tensor.data[i] << "\n";
-        }
-        return os;
-    }
-
-    template<typename... Args>
-    T& operator()(Args... args)
-    {
-        vector<size_t> indices = {static_cast<size_t>(args)...};
-        return (*this)(indices);
-    }
-
-    template<typename... Args>
-    T operator()(Args... args) const
-    {
-        vector<size_t> indices = {static_cast<size_t>(args)...};
-        return (*this)(indices);
-    }
-
-    // Opérateur d'affectation par déplacement
-    Tensor& operator=(Tensor<T>&& other) noexcept
-    {
-        if (this != &other)
-        {
-            data = std::move(other.data);
-            shape = std::move(other.shape);
-            strides = std::move(other.strides);
-            metric = other.metric;
-            other.metric = nullptr; // On "déplace" le pointeur de metric
-        }
-        return *this;
-    }
-
-
-    Tensor& operator=(const Tensor& other)
-    {
-        if (this != &other)
-        {
-            data = other.data;
-            shape = other.shape;
-            strides = other.strides;
-
-            if (metric)
-            {
-                delete metric;
-                metric = nullptr;
-            }
-
-            if (other.metric)
-                metric = new Tensor(*other.metric);
-        }
-        return *this;
-    }
-
-    size_t ndim() const
-    {
-        return shape.size();
-    }
-
-    const vector<size_t>& get_strides() const
-    {
-        return strides;
-    }
-
-    size_t size() const
-    {
-        return data.size();
-    }
-
-    T& operator()(const vector<size_t>& indices)
-    {
-        return data[flatten_index(indices)];
-    }
-
-    T operator()(const vector<size_t>& indices) const
-    {
-        return data[flatten_index(indices)];
-    }
-
-    Tensor operator+(const Tensor& other) const
-    {
-        check_shape_match(other);
-        Tensor result(shape);
-        std::transform(data.begin(), data.end(), other.data.begin(), result.data.begin(), std::plus<T>());
-        return result;
-    }
-
-
-    Tensor operator*(const Tensor& other) const
-    {
-        check_shape_match(other);
-        Tensor result(shape);
-        std::transform(data.begin(), data.end(), other.data.begin(), result.data.begin(), std::multiplies<T>());
-        return result;
-    }
-/*
-    Tensor operator*(T scalar) const
-    {
-        Tensor result(shape);
-        std::transform(data.begin(), data.end(), result.data.begin(), [scalar](T val) { return val * scalar; });
-        return result;
-    }
-    */
-    template<typename U>
-    Tensor operator*(const U& scalar) const {
-    Tensor result(shape);
-    std::transform(data.begin(), data.end(), result.data.begin(),
-                   [scalar](const T& val) { return val * static_cast<T>(scalar); });
-    return result;
-    }
-
-    template<typename U>
-    friend Tensor operator*(const U& scalar, const Tensor& tensor) {
-    return tensor * scalar; // réutilise la logique de l'opérateur déjà défini
-    }
-
-    T sum() const
-    {
-        return accumulate(data.begin(), data.end(), T());
-    }
-
-    T pseudo_norm() const
-    {
-        if (!metric)
-        {
-            return std::accumulate(data.begin(), data.end(), T(0), [](T sum, T val) { return sum + val * val; });
-        }
-        else
-        {
-            const Tensor<T>& G = *metric;
-            T norm_squared = 0.0;
-            for (size_t i = 0; i < shape[0]; ++i)
-            {
-                for (size_t j = 0; j < shape[0]; ++j)
-                {
-                    norm_squared += data[i] * G({i, j}) * data[j];
-                }
-            }
-            return norm_squared;
-        }
-    }
-
-
-    void fill(T val)
-    {
-        std::fill(data.begin(), data.end(), val);
-    }
-
-
-    void print(bool detailed = false) const
-    {
-        if (detailed)
-        {
-            std::cout << "Shape: ";
-            if(shape.size()!=0)
-            {
-            for (auto s : shape) std::cout << s << " ";
-            std::cout << std::endl;
-            }
-            else cout<<"1d"<<endl;
-        }
-
-        if (shape.size() == 0)
-        {
-            // Tenseur scalaire
-            std::cout << data[0] << std::endl;
-        }
-        else if (shape.size() == 1)
-        {
-            // Vecteur 1D
-            for (size_t i = 0; i < shape[0]; ++i)
-                std::cout << (*this)({i}) << " ";
-            std::cout << std::endl;
-        }
-        else if (shape.size() == 2)
-        {
-            // Matrice 2D
-            for (size_t i = 0; i < shape[0]; ++i)
-            {
-                for (size_t j = 0; j < shape[1]; ++j)
-                {
-                    std::cout << (*this)({i, j}) << " ";
-                }
-                std::cout << std::endl;
-            }
-        }
-        else
-        {
-            // Tenseur >2D
-            printMatrixRepresentation(); // ou ta méthode personnalisée
-        }
-    }
-
-void reshape(const vector<size_t>& new_shape)
-    {
-        size_t new_total = std::accumulate(new_shape.begin(), new_shape.end(), size_t(1), std::multiplies<size_t>());
-        if (new_total != data.size()) throw runtime_error("Reshape size mismatch");
-        shape = new_shape;
-        compute_strides();
-    }
-
-    const vector<T>& get_data() const
-    {
-        return data;
-    }
- void set_metric(const Tensor<T>& metric_tensor)
-    {
-        delete metric;
-        metric = new Tensor(metric_tensor);
-    }
-
-    Tensor<T>* get_metric() const
-    {
-        return metric;
-    }
-
-
- Tensor<T> slice(const vector<tuple<size_t, size_t, size_t>>& slices) const
-    {
-        vector<size_t> new_shape = shape;
-        vector<pair<size_t, size_t>> slice_ranges(shape.size(), {0, 0});
-        for (const auto& s : slices)
-        {
-            size_t dim, start, end;
-            std::tie(dim, start, end) = s;
-            if (dim >= shape.size() || start >= end || end > shape[dim])
-                throw out_of_range("Invalid slice range");
-
-            slice_ranges[dim] = {start, end};
-            new_shape[dim] = end - start;
-        }
-
-        Tensor<T> result(new_shape);
-        slice_data(slice_ranges, result);
-        return result;
-    }
-
-
-
-    void printMatrixRepresentation() const
-    {
-        for (size_t i = 0; i < shape[0]; ++i)
-        {
-            std::cout << "Slice " << i << " :\n";
-            for (size_t j = 0; j < shape[1]; ++j)
-            {
-                for (size_t k = 0; k < shape[2]; ++k)
-                {
-                    std::cout << (*this)({i, j, k}) << " ";
-                }
-                std::cout << std::endl;
-            }
-            std::cout << std::endl;
-        }
-    }
-
-    vector<size_t> flatten_to_indices(size_t index, const vector<size_t>& other_shape) const
-    {
-        vector<size_t> indices(other_shape.size(), 0);
-        size_t remaining_index = index;
-
-        for (int i = other_shape.size() - 1; i >= 0; --i)
-        {
-            indices[i] = remaining_index % other_shape[i];
-            remaining_index /= other_shape[i];
-        }
-        return indices;
-    }
-
-
-    Tensor<T> tensor_product(const Tensor<T>& other) const
-    {
-        // Nouvelle forme du tenseur résultant (Kronecker)
-        vector<size_t> new_shape;
-
-        // On suppose ici que les deux tenseurs ont la même taille pour chaque dimension
-        size_t ndim_a = shape.size();
-        size_t ndim_b = other.shape.size();
-        size_t max_ndim = max(ndim_a, ndim_b);
-
-        // Calcul des nouvelles dimensions pour le produit tensoriel
-        for (size_t i = 0; i < max_ndim; ++i)
-        {
-            size_t dim_a = (i < ndim_a) ? shape[i] : 1;  // Si la dimension n'existe pas, on prend 1
-            size_t dim_b = (i < ndim_b) ? other.shape[i] : 1; // Idem pour l'autre tenseur
-            new_shape.push_back(dim_a * dim_b);
-            // cout<<"--->"<<dim_a * dim_b<<endl;
-        }
-
-
-        // Créer le tenseur résultant avec la forme calculée
-        Tensor<T> result(new_shape);
-      //  result.print();
-
-        for (size_t i = 0; i < data.size(); ++i)
-        {
-            vector<size_t> indices_a = flatten_to_indices(i, shape);
-
-            for (size_t j = 0; j < other.data.size(); ++j)
-            {
-                vector<size_t> indices_b = flatten_to_indices(j, other.shape);
-
-                vector<size_t> new_indices;
-                size_t ndim = result.shape.size(); // Taille du tenseur résultat
-
-                // On "pad" les indices manquants avec 0
-                while (indices_a.size() < ndim)
-                    indices_a.push_back(0);
-                while (indices_b.size() < ndim)
-                    indices_b.push_back(0);
-
-                for (size_t k = 0; k < ndim; ++k)
-                {
-                    size_t dim_a = (k < shape.size()) ? shape[k] : 1;
-                    size_t dim_b = (k < other.shape.size()) ? other.shape[k] : 1;
-
-                    size_t index = (indices_a[k] * dim_b) + indices_b[k];
-                    new_indices.push_back(index);
-                }
-
-                T res = data[i] * other.data[j];
-                result(new_indices) = res;
-            }
-        }
-
-        return result;
-    }
-
-    Tensor<T> permute(const vector<size_t>& order) const
-    {
-        if (order.size() != shape.size())
-            throw runtime_error("Order size must match the number of dimensions");
-
-        vector<size_t> new_shape(shape.size());
-        for (size_t i = 0; i < shape.size(); ++i)
-            new_shape[i] = shape[order[i]];
-
-        Tensor<T> result(new_shape);
-        vector<size_t> old_indices(shape.size());
-        vector<size_t> new_indices(shape.size());
-
-        for (size_t i = 0; i < data.size(); ++i)
-        {
-            old_indices = flatten_to_indices(i, shape);
-            for (size_t j = 0; j < shape.size(); ++j)
-                new_indices[j] = old_indices[order[j]];
-
-            result(new_indices) = data[i];
-        }
-
-        return result;
-    }
-
-    const vector<size_t>& get_shape()
-    {
-        return shape;
-    }
-
-
-    Tensor<T> contract(size_t axis1, size_t axis2) const
-    {
-        if (axis1 >= shape.size() || axis2 >= shape.size())
-            throw std::runtime_error("Invalid axis");
-
-        if (axis1 == axis2)
-            throw std::runtime_error("Cannot contract the same axis");
-
-        if (shape[axis1] != shape[axis2])
-            throw std::runtime_error("Cannot contract axes with different sizes");
-
-        // Déterminer la nouvelle forme après contraction
-        vector<size_t> new_shape;
-        for (size_t i = 0; i < shape.size(); ++i)
-        {
-            if (i != axis1 && i != axis2)
-                new_shape.push_back(shape[i]);
-        }
-
-        // Résultat initialisé à zéro (même si new_shape est vide)
-        Tensor<T> result(new_shape, T(0));
-
-        vector<size_t> indices(shape.size());
-
-        for (size_t i = 0; i < data.size(); ++i)
-        {
-            indices = flatten_to_indices(i, shape);
-
-            // Conserver seulement les cas où les deux axes ont la même valeur (contraction diagonale)
-            if (indices[axis1] == indices[axis2])
-            {
-                vector<size_t> reduced_indices;
-                for (size_t j = 0; j < indices.size(); ++j)
-                {
-                    if (j != axis1 && j != axis2)
-                        reduced_indices.push_back(indices[j]);
-                }
-                result(reduced_indices) += data[i];
-            }
-        }
-
-        return result;
-    }
-
-    Tensor<T> flatten() const
-    {
-        return Tensor<T>({data.size()}, data);
-    }
-
-
-    Tensor<T> contract_with(const Tensor<T>& B, size_t axis_A, size_t axis_B) const
-    {
-        if (axis_A >= shape.size() || axis_B >= B.shape.size())
-            throw std::runtime_error("Invalid contraction axes");
-
-        size_t dim = shape[axis_A];
-        if (dim != B.shape[axis_B])
-            throw std::runtime_error("Mismatched dimensions for contraction");
-
-        bool use_metric = (metric != nullptr);
-        if (use_metric)
-        {
-            if (metric->shape.size() != 2 || metric->shape[0] != dim || metric->shape[1] != dim)
-                throw std::runtime_error("Metric must be a square matrix matching contraction dimension");
-        }
-
-        // Compute shape of result
-        std::vector<size_t> new_shape;
-        for (size_t i = 0; i < shape.size(); ++i)
-            if (i != axis_A)
-                new_shape.push_back(shape[i]);
-
-        for (size_t i = 0; i < B.shape.size(); ++i)
-            if (i != axis_B)
-                new_shape.push_back(B.shape[i]);
-
-        Tensor<T> result(new_shape, T{});
-
-        // Temporary indices
-        std::vector<size_t> idx_A(shape.size());
-        std::vector<size_t> idx_B(B.shape.size());
-        std::vector<size_t> idx_res(result.shape.size());
-
-        size_t total = result.data.size();
-        for (size_t r = 0; r < total; ++r)
-        {
-            idx_res = result.flatten_to_indices(r, result.shape);
-
-            size_t ai = 0;
-            for (size_t i = 0; i < shape.size(); ++i)
-                if (i != axis_A)
-                    idx_A[i] = idx_res[ai++];
-
-            size_t bi = 0;
-            for (size_t i = 0; i < B.shape.size(); ++i)
-                if (i != axis_B)
-                    idx_B[i] = idx_res[ai + bi++];
-
-            T sum = T{};
-            for (size_t k = 0; k < dim; ++k)
-            {
-                idx_A[axis_A] = k;
-                for (size_t l = 0; l < dim; ++l)
-                {
-                    idx_B[axis_B] = l;
-
-                    T m = (use_metric ? (*metric)({k, l}) : (k == l ? T{1} : T{0}));
-                    sum  = sum + (*this)(idx_A) * m * B(idx_B);
-                }
-            }
-
-            result.data[r] = sum;
-        }
-
-        return result;
-    }
-
-    Tensor<T> contract_with_metric(size_t axis1, size_t axis2) const
-    {
-        if (axis1 >= shape.size() || axis2 >= shape.size())
-            throw std::runtime_error("Invalid axis indices");
-
-        if (shape[axis1] != shape[axis2])
-            throw std::runtime_error("Axes must have the same dimension");
-
-        // Si aucun tenseur métrique défini → matrice identité
-        Tensor<T> identity_metric({shape[axis1], shape[axis2]}, T(0));
-        if (!metric)
-        {
-            for (size_t i = 0; i < shape[axis1]; ++i)
-                identity_metric({i, i}) = T(1);
-        }
-
-        const Tensor<T>& g = metric ? *metric : identity_metric;
-
-        // Nouvelle forme sans les axes contractés
-        std::vector<size_t> new_shape;
-        for (size_t i = 0; i < shape.size(); ++i)
-        {
-            if (i != axis1 && i != axis2)
-                new_shape.push_back(shape[i]);
-        }
-
-        Tensor<T> result(new_shape, T(0));
-        std::vector<size_t> idx(shape.size());
-
-        for (size_t i = 0; i < data.size(); ++i)
-        {
-            idx = flatten_to_indices(i, shape);
-            std::vector<size_t> reduced_idx;
-            for (size_t j = 0; j < idx.size(); ++j)
-            {
-                if (j != axis1 && j != axis2)
-                    reduced_idx.push_back(idx[j]);
-            }
-
-            T sum = T(0);
-            for (size_t k = 0; k < shape[axis1]; ++k)
-            {
-                for (size_t l = 0; l < shape[axis2]; ++l)
-                {
-                    idx[axis1] = k;
-                    idx[axis2] = l;
-                    sum += (*this)(idx) * g({k, l});
-                }
-            }
-            result(reduced_idx) += sum;
-        }
-
-        return result;
-    }
-
-
-};
-
-#endif // TENSEURS_H_INCLUDED
+///  -------------------------------------------------
+///  Tensor Class 14/04/2024 optimisation ...
+///  StandAlone class for Tensor operations
+///  Coded by JP CHAMPEAUX
+///  contact : JPC@irsamc.upse-tlse.fr
+///  Free of use for Academic purpose only !
+///  (please, just mention author in your works if used or if your own code is inspired from it)
+///  CLASS Tensor
+///  --------------------------------------------------
+
+
+#ifndef TENSEURS_H_INCLUDED
+#define TENSEURS_H_INCLUDED
+
+#include <vector>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <cmath>
+#include <tuple>
+#include <algorithm>
+#include <type_traits>
+#include <string>
+#include <cctype>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "Tenseurs_kernels.h"
+#include "Tenseurs_parallel.h"
+#include "Tenseurs_alloc.h"
+#include "Tenseurs_io.h"
+#include "Tenseurs_profile.h"
+
+using namespace std;
+
+/// Vérification du rang et des bornes dans operator() : active par défaut,
+/// désactivée avec NDEBUG (ou -DTENSOR_BOUNDS_CHECK=0). at() vérifie toujours.
+#ifndef TENSOR_BOUNDS_CHECK
+#ifdef NDEBUG
+#define TENSOR_BOUNDS_CHECK 0
+#else
+#define TENSOR_BOUNDS_CHECK 1
+#endif
+#endif
+
+template<typename T, typename Alloc = default_tensor_allocator<T>>
+class Tensor;
+
+template<typename T>
+class KroneckerView;
+
+template<typename T>
+class Metric;
+
+template<typename T>
+class MappedTensor;
+
+/// Copie à l'écriture des buffers (opt-in) : -DTENSOR_COPY_ON_WRITE=1.
+/// Les copies de Tensor partagent alors leur buffer jusqu'à la première écriture.
+#ifndef TENSOR_COPY_ON_WRITE
+#define TENSOR_COPY_ON_WRITE 0
+#endif
+
+/// Structure du tenseur métrique, déterminée une fois par set_metric
+enum class MetricKind
+{
+    Identity,   // g = 1
+    Diagonal,   // g_ij = 0 si i != j (Minkowski, ...)
+    Symmetric,  // g_ij = g_ji
+    Dense       // cas général (ou type non arithmétique)
+};
+
+/// Vue non propriétaire (shape + strides + offset) sur le buffer d'un Tensor.
+/// slice / permute / reshape / flatten ne copient rien : O(rank).
+/// contiguous() matérialise la vue dans un nouveau Tensor.
+/// La vue ne prolonge pas la durée de vie du tenseur source.
+template<typename T>
+class TensorView
+{
+public:
+    using value_type = typename std::remove_const<T>::type;
+
+private:
+    T* base = nullptr;
+    vector<size_t> shape;
+    vector<size_t> strides;
+    size_t offset = 0;
+
+    size_t flatten_index(const vector<size_t>& indices) const
+    {
+        if (indices.size() != shape.size())
+            throw runtime_error("Index dimension mismatch");
+
+        size_t idx = offset;
+        for (size_t i = 0; i < shape.size(); ++i)
+        {
+            if (indices[i] >= shape[i])
+                throw out_of_range("Index out of bounds");
+            idx += indices[i] * strides[i];
+        }
+        return idx;
+    }
+
+    // Indice plat sans allocation ni vérification
+    template<typename... Args>
+    size_t offset_of(Args... args) const
+    {
+        size_t idx = offset, d = 0;
+        ((idx += static_cast<size_t>(args) * strides[d++]), ...);
+        return idx;
+    }
+
+    template<typename... Args>
+    void check_indices(Args... args) const
+    {
+        if (sizeof...(Args) != shape.size())
+            throw runtime_error("Index dimension mismatch");
+        size_t d = 0;
+        if (!((static_cast<size_t>(args) < shape[d++]) && ...))
+            throw out_of_range("Index out of bounds");
+    }
+
+public:
+    TensorView() = default;
+
+    TensorView(T* base_, const vector<size_t>& shape_, const vector<size_t>& strides_, size_t offset_ = 0)
+        : base(base_), shape(shape_), strides(strides_), offset(offset_)
+    {
+        if (shape.size() != strides.size())
+            throw runtime_error("Shape and strides must have the same rank");
+    }
+
+    // Une vue mutable se convertit en vue constante
+    operator TensorView<const T>() const
+    {
+        return TensorView<const T>(base, shape, strides, offset);
+    }
+
+    template<typename... Args>
+    T& operator()(Args... args) const
+    {
+#if TENSOR_BOUNDS_CHECK
+        check_indices(args...);
+#endif
+        return base[offset_of(args...)];
+    }
+
+    T& operator()(const vector<size_t>& indices) const
+    {
+#if TENSOR_BOUNDS_CHECK
+        return base[flatten_index(indices)];
+#else
+        size_t idx = offset;
+        for (size_t i = 0; i < indices.size(); ++i)
+            idx += indices[i] * strides[i];
+        return base[idx];
+#endif
+    }
+
+    template<typename... Args>
+    T& at(Args... args) const
+    {
+        check_indices(args...);
+        return base[offset_of(args...)];
+    }
+
+    T& at(const vector<size_t>& indices) const
+    {
+        return base[flatten_index(indices)];
+    }
+
+    size_t ndim() const
+    {
+        return shape.size();
+    }
+
+    size_t size() const
+    {
+        return std::accumulate(shape.begin(), shape.end(), size_t(1), std::multiplies<size_t>());
+    }
+
+    const vector<size_t>& get_shape() const
+    {
+        return shape;
+    }
+
+    const vector<size_t>& get_strides() const
+    {
+        return strides;
+    }
+
+    size_t get_offset() const
+    {
+        return offset;
+    }
+
+    T* get_base() const
+    {
+        return base;
+    }
+
+    // Vrai si les éléments sont rangés en row-major sans trou
+    bool is_contiguous() const
+    {
+        size_t stride = 1;
+        for (int i = shape.size() - 1; i >= 0; --i)
+        {
+            if (shape[i] != 1 && strides[i] != stride)
+                return false;
+            stride *= shape[i];
+        }
+        return true;
+    }
+
+    TensorView slice(const vector<tuple<size_t, size_t, size_t>>& slices) const
+    {
+        TensorView result(*this);
+        for (const auto& s : slices)
+        {
+            size_t dim, start, end;
+            std::tie(dim, start, end) = s;
+            if (dim >= shape.size() || start >= end || end > shape[dim])
+                throw out_of_range("Invalid slice range");
+
+            result.offset += start * strides[dim];
+            result.shape[dim] = end - start;
+        }
+        return result;
+    }
+
+    /// Tranches avec pas : (dim, start, end, step), step >= 1.
+    /// start / end négatifs comptés depuis la fin et bornés comme en Python (a[-3:], a[::2]) ;
+    /// une tranche vide donne une dimension nulle. Seuls offset, shape et strides changent.
+    TensorView slice(const vector<tuple<size_t, ptrdiff_t, ptrdiff_t, size_t>>& slices) const
+    {
+        TensorView result(*this);
+        for (const auto& s : slices)
+        {
+            size_t dim, step;
+            ptrdiff_t start, end;
+            std::tie(dim, start, end, step) = s;
+            if (dim >= shape.size())
+                throw out_of_range("Invalid slice dimension");
+            if (step == 0)
+                throw runtime_error("Slice step must be positive");
+
+            ptrdiff_t n = static_cast<ptrdiff_t>(result.shape[dim]);
+            auto clamp = [n](ptrdiff_t i)
+            {
+                if (i < 0)
+                    i += n;
+                return std::min(std::max(i, ptrdiff_t(0)), n);
+            };
+            start = clamp(start);
+            end = clamp(end);
+
+            size_t count = (start < end) ? static_cast<size_t>(end - start - 1) / step + 1 : 0;
+            if (count)
+                result.offset += static_cast<size_t>(start) * result.strides[dim];
+            result.shape[dim] = count;
+            result.strides[dim] *= step;
+        }
+        return result;
+    }
+
+    /// Sélection d'indices quelconques sur un axe (copie) : take(1, {0, 5, 2})
+    Tensor<value_type> take(size_t dim, const vector<size_t>& indices) const
+    {
+        if (dim >= shape.size())
+            throw out_of_range("Invalid take dimension");
+        for (size_t i : indices)
+            if (i >= shape[dim])
+                throw out_of_range("Index out of bounds");
+
+        // Axe sélectionné en premier : chaque indice est une copie par blocs de la sous-vue
+        vector<size_t> rest_shape, rest_strides, order(1, dim);
+        for (size_t d = 0; d < shape.size(); ++d)
+        {
+            if (d != dim)
+            {
+                rest_shape.push_back(shape[d]);
+                rest_strides.push_back(strides[d]);
+                order.push_back(d);
+            }
+        }
+        size_t block = std::accumulate(rest_shape.begin(), rest_shape.end(), size_t(1), std::multiplies<size_t>());
+
+        vector<size_t> gathered_shape(1, indices.size());
+        gathered_shape.insert(gathered_shape.end(), rest_shape.begin(), rest_shape.end());
+        Tensor<value_type> gathered(gathered_shape);
+        for (size_t k = 0; k < indices.size(); ++k)
+            tensor_kernels::strided_copy(base + offset + indices[k] * strides[dim], rest_shape, rest_strides, gathered.buffer.data() + k * block);
+        if (dim == 0)
+            return gathered;
+
+        // Retour à l'ordre d'origine des axes
+        vector<size_t> back(order.size());
+        for (size_t d = 0; d < order.size(); ++d)
+            back[order[d]] = d;
+        return gathered.view().permute(back).contiguous();
+    }
+
+    TensorView permute(const vector<size_t>& order) const
+    {
+        if (order.size() != shape.size())
+            throw runtime_error("Order size must match the number of dimensions");
+
+        vector<bool> seen(shape.size(), false);
+        TensorView result(*this);
+        for (size_t i = 0; i < shape.size(); ++i)
+        {
+            if (order[i] >= shape.size() || seen[order[i]])
+                throw runtime_error("Order must be a permutation of the axes");
+            seen[order[i]] = true;
+            result.shape[i] = shape[order[i]];
+            result.strides[i] = strides[order[i]];
+        }
+        return result;
+    }
+
+    TensorView reshape(const vector<size_t>& new_shape) const
+    {
+        size_t new_total = std::accumulate(new_shape.begin(), new_shape.end(), size_t(1), std::multiplies<size_t>());
+        if (new_total != size()) throw runtime_error("Reshape size mismatch");
+        if (!is_contiguous())
+            throw runtime_error("Reshape of a non-contiguous view, call contiguous() first");
+
+        vector<size_t> new_strides(new_shape.size());
+        size_t stride = 1;
+        for (int i = new_shape.size() - 1; i >= 0; --i)
+        {
+            new_strides[i] = stride;
+            stride *= new_shape[i];
+        }
+        return TensorView(base, new_shape, new_strides, offset);
+    }
+
+    TensorView flatten() const
+    {
+        return reshape({size()});
+    }
+
+    // Copie la vue dans un Tensor contigu (axes fusionnés, transposition par tuiles)
+    Tensor<value_type> contiguous() const
+    {
+        TENSOR_PROFILE_OP("materialize", shape);
+        Tensor<value_type> result(shape);
+        tensor_kernels::strided_copy(base + offset, shape, strides, result.buffer.data());
+        TENSOR_PROFILE_COPY(result.size() * sizeof(value_type));
+        return result;
+    }
+
+    void print(bool detailed = false) const
+    {
+        contiguous().print(detailed);
+    }
+
+    friend ostream& operator<<(ostream& os, const TensorView& view)
+    {
+        return os << view.contiguous();
+    }
+};
+
+/// Expressions paresseuses pour les opérations élément par élément.
+/// A * 2.0 + B ne crée aucun tenseur temporaire : l'arbre d'expression est évalué
+/// en une seule boucle lors de l'affectation (ou de la construction) d'un Tensor.
+/// Une expression garde une référence sur ses tenseurs : l'évaluer dans la même instruction.
+///
+/// Broadcasting à la numpy : formes alignées à droite, une dimension 1 (ou absente)
+/// est répétée par un pas nul, sans recopie de l'opérande.
+/// Protocole d'un noeud : get_shape(), size(), broadcasts(), operator[](i) (accès plat,
+/// sans broadcasting), bind(forme cible), set_row(indices des dimensions externes), at(j).
+
+// Forme résultant du broadcasting de a et b
+inline vector<size_t> broadcast_shape(const vector<size_t>& a, const vector<size_t>& b)
+{
+    size_t rank = std::max(a.size(), b.size());
+    vector<size_t> result(rank);
+    for (size_t d = 0; d < rank; ++d)
+    {
+        size_t da = (d + a.size() >= rank) ? a[d + a.size() - rank] : 1;
+        size_t db = (d + b.size() >= rank) ? b[d + b.size() - rank] : 1;
+        if (da != db && da != 1 && db != 1)
+            throw runtime_error("Shape mismatch in operation");
+        result[d] = (da == 1) ? db : da;
+    }
+    return result;
+}
+
+// Lignes [r0, r1) de la forme cible, e déjà lié par bind : store(indice plat, valeur)
+template<typename E, typename F>
+void evaluate_rows(E& e, const vector<size_t>& shape, size_t r0, size_t r1, F&& store)
+{
+    size_t inner = shape.back();
+    vector<size_t> idx(shape.size() - 1, 0);
+    for (size_t d = idx.size(), r = r0; d-- > 0; r /= shape[d])
+        idx[d] = r % shape[d];
+
+    size_t out = r0 * inner;
+    for (size_t r = r0; r < r1; ++r)
+    {
+        e.set_row(idx.data());
+        for (size_t j = 0; j < inner; ++j)
+            store(out++, e.at(j));
+
+        for (size_t d = idx.size(); d-- > 0;)
+        {
+            if (++idx[d] < shape[d])
+                break;
+            idx[d] = 0;
+        }
+    }
+}
+
+// Parcourt la forme cible ligne par ligne et appelle store(indice plat, valeur)
+template<typename E, typename F>
+void evaluate_expression(E e, const vector<size_t>& shape, F&& store)
+{
+    size_t total = std::accumulate(shape.begin(), shape.end(), size_t(1), std::multiplies<size_t>());
+    if (total == 0)
+        return;
+
+    if (!e.broadcasts() && e.get_shape() == shape)
+    {
+        for (size_t i = 0; i < total; ++i)
+            store(i, e[i]);
+        return;
+    }
+
+    if (broadcast_shape(e.get_shape(), shape) != shape)
+        throw runtime_error("Shape mismatch in operation");
+
+    e.bind(shape);
+    evaluate_rows(e, shape, 0, total / shape.back(), store);
+}
+
+// Correspondance foncteur -> noyau SIMD
+template<typename Op>
+struct element_op_of;
+
+template<typename T>
+struct element_op_of<std::plus<T>> : std::integral_constant<tensor_kernels::ElementOp, tensor_kernels::ElementOp::Add> {};
+
+template<typename T>
+struct element_op_of<std::minus<T>> : std::integral_constant<tensor_kernels::ElementOp, tensor_kernels::ElementOp::Sub> {};
+
+template<typename T>
+struct element_op_of<std::multiplies<T>> : std::integral_constant<tensor_kernels::ElementOp, tensor_kernels::ElementOp::Mul> {};
+
+template<typename T>
+struct element_op_of<std::divides<T>> : std::integral_constant<tensor_kernels::ElementOp, tensor_kernels::ElementOp::Div> {};
+
+// Taille des blocs de l'évaluation vectorisée (reste en L1)
+constexpr size_t EXPRESSION_BLOCK = 256;
+
+// Écriture du résultat : affectation, ou combinaison avec la destination (+=, -=, *=, /=)
+enum class StoreMode
+{
+    Assign,
+    Add,
+    Sub,
+    Mul,
+    Div
+};
+
+/// out = e (ou out op= e) sur la forme shape.
+/// float / double sans broadcasting : évaluation par blocs avec les noyaux SIMD ;
+/// sinon boucle générique de evaluate_expression.
+/// Types arithmétiques : les blocs (ou les lignes) sont répartis sur le pool de threads.
+template<StoreMode Mode, typename E, typename T>
+void evaluate_into(const E& e, const vector<size_t>& shape, T* out)
+{
+    if constexpr (tensor_kernels::is_simd_type<T>::value)
+    {
+        if (!e.broadcasts() && e.get_shape() == shape)
+        {
+            const tensor_kernels::SimdKernels<T>& k = tensor_kernels::simd<T>();
+            size_t total = e.size();
+            size_t n_blocks = (total + EXPRESSION_BLOCK - 1) / EXPRESSION_BLOCK;
+            tensor_kernels::parallel_for(0, n_blocks, tensor_kernels::PARALLEL_GRAIN / EXPRESSION_BLOCK, [&](size_t b0, size_t b1)
+            {
+                T tmp[EXPRESSION_BLOCK];
+                for (size_t i0 = b0 * EXPRESSION_BLOCK; i0 < std::min(total, b1 * EXPRESSION_BLOCK); i0 += EXPRESSION_BLOCK)
+                {
+                    size_t n = std::min(EXPRESSION_BLOCK, total - i0);
+                    const T* src = e.direct(i0);
+                    if constexpr (Mode == StoreMode::Assign)
+                    {
+                        // Affectation : le bloc est calculé directement dans la destination
+                        if (src)
+                            std::copy(src, src + n, out + i0);
+                        else
+                            e.eval_block(i0, n, out + i0);
+                        continue;
+                    }
+                    if (!src)
+                    {
+                        e.eval_block(i0, n, tmp);
+                        src = tmp;
+                    }
+                    k.binary(static_cast<tensor_kernels::ElementOp>(static_cast<int>(Mode) - 1), out + i0, src, out + i0, n);
+                }
+            });
+            return;
+        }
+    }
+
+    auto store = [out](size_t i, const T& v)
+    {
+        if constexpr (Mode == StoreMode::Assign)
+            out[i] = v;
+        else if constexpr (Mode == StoreMode::Add)
+            out[i] = out[i] + v;
+        else if constexpr (Mode == StoreMode::Sub)
+            out[i] = out[i] - v;
+        else if constexpr (Mode == StoreMode::Mul)
+            out[i] = out[i] * v;
+        else
+            out[i] = out[i] / v;
+    };
+
+    if constexpr (std::is_arithmetic<T>::value)
+    {
+        size_t total = std::accumulate(shape.begin(), shape.end(), size_t(1), std::multiplies<size_t>());
+        if (total > tensor_kernels::PARALLEL_GRAIN)
+        {
+            if (!e.broadcasts() && e.get_shape() == shape)
+            {
+                tensor_kernels::parallel_for(0, total, tensor_kernels::PARALLEL_GRAIN, [&](size_t lo, size_t hi)
+                {
+                    for (size_t i = lo; i < hi; ++i)
+                        store(i, e[i]);
+                });
+                return;
+            }
+
+            if (broadcast_shape(e.get_shape(), shape) != shape)
+                throw runtime_error("Shape mismatch in operation");
+
+            // Chaque morceau de lignes lie sa propre copie de l'expression
+            size_t inner = shape.back();
+            tensor_kernels::parallel_for(0, total / inner, std::max<size_t>(1, tensor_kernels::PARALLEL_GRAIN / inner), [&](size_t r0, size_t r1)
+            {
+                E local = e;
+                local.bind(shape);
+                evaluate_rows(local, shape, r0, r1, store);
+            });
+            return;
+        }
+    }
+
+    evaluate_expression(e, shape, store);
+}
+
+template<typename Derived, typename T>
+class TensorExpression
+{
+public:
+    using value_type = T;
+
+    const Derived& self() const
+    {
+        return static_cast<const Derived&>(*this);
+    }
+
+    Tensor<T> eval() const
+    {
+        return Tensor<T>(*this);
+    }
+
+    T sum() const
+    {
+        const Derived& e = self();
+        if constexpr (tensor_kernels::is_simd_type<T>::value)
+        {
+            if (!e.broadcasts())
+            {
+                // Sommes partielles par morceaux fixes : résultat indépendant du nombre de threads
+                return tensor_kernels::parallel_reduce(e.size(), tensor_kernels::PARALLEL_GRAIN, T(0), [&e](size_t lo, size_t hi)
+                {
+                    T acc = T(0);
+                    T tmp[EXPRESSION_BLOCK];
+                    for (size_t i0 = lo; i0 < hi; i0 += EXPRESSION_BLOCK)
+                    {
+                        size_t n = std::min(EXPRESSION_BLOCK, hi - i0);
+                        const T* src = e.direct(i0);
+                        if (!src)
+                        {
+                            e.eval_block(i0, n, tmp);
+                            src = tmp;
+                        }
+                        acc += tensor_kernels::simd<T>().sum(src, n);
+                    }
+                    return acc;
+                }, std::plus<T>());
+            }
+        }
+        T acc = T();
+        evaluate_expression(e, e.get_shape(), [&acc](size_t, const T& v) { acc = acc + v; });
+        return acc;
+    }
+
+    void print(bool detailed = false) const
+    {
+        eval().print(detailed);
+    }
+
+    friend ostream& operator<<(ostream& os, const TensorExpression& e)
+    {
+        return os << e.eval();
+    }
+};
+
+// Feuille : accès direct au buffer d'un Tensor
+template<typename T>
+class TensorLeaf : public TensorExpression<TensorLeaf<T>, T>
+{
+private:
+    const T* ptr;
+    const vector<size_t>* shape;
+    const vector<size_t>* strides;
+    size_t total;
+
+    // Pas de la feuille sur la forme cible (0 pour une dimension répétée)
+    vector<size_t> bcast_strides;
+    size_t row_offset = 0;
+    size_t inner_stride = 0;
+
+public:
+    template<typename Alloc>
+    explicit TensorLeaf(const Tensor<T, Alloc>& t)
+        : ptr(t.data()), shape(&t.get_shape()), strides(&t.get_strides()), total(t.size())
+    {
+    }
+
+    // Fichier projeté : lu en place, page par page
+    template<typename U>
+    explicit TensorLeaf(const MappedTensor<U>& m)
+        : ptr(m.data()), shape(&m.get_shape()), strides(&m.get_strides()), total(m.size())
+    {
+        if (!m.is_contiguous())
+            throw runtime_error("Mapped tensor is not contiguous");
+    }
+
+    T operator[](size_t i) const
+    {
+        return ptr[i];
+    }
+
+    // Évaluation par blocs (float / double) : une feuille est lue en place
+    const T* direct(size_t i0) const
+    {
+        return ptr + i0;
+    }
+
+    void eval_block(size_t i0, size_t n, T* out) const
+    {
+        std::copy(ptr + i0, ptr + i0 + n, out);
+    }
+
+    const vector<size_t>& get_shape() const
+    {
+        return *shape;
+    }
+
+    size_t size() const
+    {
+        return total;
+    }
+
+    bool broadcasts() const
+    {
+        return false;
+    }
+
+    void bind(const vector<size_t>& target)
+    {
+        size_t rank = target.size();
+        size_t shift = rank - shape->size();
+        bcast_strides.assign(rank, 0);
+        for (size_t d = shift; d < rank; ++d)
+            if ((*shape)[d - shift] != 1)
+                bcast_strides[d] = (*strides)[d - shift];
+        inner_stride = bcast_strides.back();
+    }
+
+    void set_row(const size_t* idx)
+    {
+        row_offset = 0;
+        for (size_t d = 0; d + 1 < bcast_strides.size(); ++d)
+            row_offset += idx[d] * bcast_strides[d];
+    }
+
+    T at(size_t j) const
+    {
+        return ptr[row_offset + j * inner_stride];
+    }
+};
+
+template<typename L, typename R, typename Op>
+class TensorBinaryExpr : public TensorExpression<TensorBinaryExpr<L, R, Op>, typename L::value_type>
+{
+private:
+    L lhs;
+    R rhs;
+    vector<size_t> shape;
+    size_t total;
+    bool bcast;
+
+public:
+    TensorBinaryExpr(const L& lhs_, const R& rhs_)
+        : lhs(lhs_), rhs(rhs_), shape(broadcast_shape(lhs_.get_shape(), rhs_.get_shape()))
+    {
+        total = std::accumulate(shape.begin(), shape.end(), size_t(1), std::multiplies<size_t>());
+        bcast = lhs.broadcasts() || rhs.broadcasts() || lhs.get_shape() != shape || rhs.get_shape() != shape;
+    }
+
+    typename L::value_type operator[](size_t i) const
+    {
+        return Op()(lhs[i], rhs[i]);
+    }
+
+    const typename L::value_type* direct(size_t) const
+    {
+        return nullptr;
+    }
+
+    void eval_block(size_t i0, size_t n, typename L::value_type* out) const
+    {
+        using T = typename L::value_type;
+        const T* a = lhs.direct(i0);
+        if (!a)
+        {
+            lhs.eval_block(i0, n, out);
+            a = out;
+        }
+        T tmp[EXPRESSION_BLOCK];
+        const T* b = rhs.direct(i0);
+        if (!b)
+        {
+            rhs.eval_block(i0, n, tmp);
+            b = tmp;
+        }
+        tensor_kernels::simd<T>().binary(element_op_of<Op>::value, a, b, out, n);
+    }
+
+    const vector<size_t>& get_shape() const
+    {
+        return shape;
+    }
+
+    size_t size() const
+    {
+        return total;
+    }
+
+    bool broadcasts() const
+    {
+        return bcast;
+    }
+
+    void bind(const vector<size_t>& target)
+    {
+        lhs.bind(target);
+        rhs.bind(target);
+    }
+
+    void set_row(const size_t* idx)
+    {
+        lhs.set_row(idx);
+        rhs.set_row(idx);
+    }
+
+    typename L::value_type at(size_t j) const
+    {
+        return Op()(lhs.at(j), rhs.at(j));
+    }
+};
+
+// Opération avec un scalaire : la conversion du scalaire en T n'est faite qu'une fois
+template<typename E, typename Op>
+class TensorScalarExpr : public TensorExpression<TensorScalarExpr<E, Op>, typename E::value_type>
+{
+public:
+    using T = typename E::value_type;
+
+private:
+    E expr;
+    T scalar;
+
+public:
+    TensorScalarExpr(const E& expr_, const T& scalar_)
+        : expr(expr_), scalar(scalar_)
+    {
+    }
+
+    T operator[](size_t i) const
+    {
+        return Op()(expr[i], scalar);
+    }
+
+    const T* direct(size_t) const
+    {
+        return nullptr;
+    }
+
+    void eval_block(size_t i0, size_t n, T* out) const
+    {
+        const T* a = expr.direct(i0);
+        if (!a)
+        {
+            expr.eval_block(i0, n, out);
+            a = out;
+        }
+        tensor_kernels::simd<T>().binary_scalar(element_op_of<Op>::value, a, scalar, out, n);
+    }
+
+    const vector<size_t>& get_shape() const
+    {
+        return expr.get_shape();
+    }
+
+    size_t size() const
+    {
+        return expr.size();
+    }
+
+    bool broadcasts() const
+    {
+        return expr.broadcasts();
+    }
+
+    void bind(const vector<size_t>& target)
+    {
+        expr.bind(target);
+    }
+
+    void set_row(const size_t* idx)
+    {
+        expr.set_row(idx);
+    }
+
+    T at(size_t j) const
+    {
+        return Op()(expr.at(j), scalar);
+    }
+};
+
+// Opérations par élément d'une expression (FLOP comptés par le profilage)
+template<typename E>
+struct expression_ops : std::integral_constant<size_t, 0> {};
+
+template<typename L, typename R, typename Op>
+struct expression_ops<TensorBinaryExpr<L, R, Op>> : std::integral_constant<size_t, 1 + expression_ops<L>::value + expression_ops<R>::value> {};
+
+template<typename E, typename Op>
+struct expression_ops<TensorScalarExpr<E, Op>> : std::integral_constant<size_t, 1 + expression_ops<E>::value> {};
+
+// Tensor et expressions sont des opérandes ; tout le reste est un scalaire
+template<typename X>
+struct is_tensor_operand
+{
+private:
+    template<typename D, typename T>
+    static std::true_type test(const TensorExpression<D, T>*);
+    template<typename T, typename Alloc>
+    static std::true_type test(const Tensor<T, Alloc>*);
+    template<typename U>
+    static std::true_type test(const MappedTensor<U>*);
+    static std::false_type test(...);
+
+public:
+    static constexpr bool value = decltype(test(std::declval<const X*>()))::value;
+};
+
+template<typename T, typename Alloc>
+TensorLeaf<T> as_expression(const Tensor<T, Alloc>& t)
+{
+    return TensorLeaf<T>(t);
+}
+
+template<typename U>
+TensorLeaf<typename std::remove_const<U>::type> as_expression(const MappedTensor<U>& m)
+{
+    return TensorLeaf<typename std::remove_const<U>::type>(m);
+}
+
+template<typename D, typename T>
+const D& as_expression(const TensorExpression<D, T>& e)
+{
+    return e.self();
+}
+
+template<typename X>
+using expression_type = typename std::decay<decltype(as_expression(std::declval<const X&>()))>::type;
+
+/// Buffer partagé à la copie et recopié à la première écriture (TENSOR_COPY_ON_WRITE).
+/// Compteur de références atomique (shared_ptr) : les copies peuvent circuler entre threads.
+/// Tout accès non const (operator[], data(), begin(), resize) détache d'abord un buffer partagé.
+/// Une fois un pointeur modifiable exposé (Tensor::data(), vue modifiable), mark_unshareable()
+/// rend les copies suivantes profondes, sinon une écriture par ce pointeur toucherait les copies.
+template<typename T, typename Alloc = std::allocator<T>>
+class CowBuffer
+{
+    shared_ptr<vector<T, Alloc>> storage;
+    bool shareable = true;
+
+    void detach()
+    {
+        if (!storage)
+            storage = make_shared<vector<T, Alloc>>();
+        else if (storage.use_count() > 1)
+            storage = make_shared<vector<T, Alloc>>(*storage);
+    }
+
+    shared_ptr<vector<T, Alloc>> share() const
+    {
+        if (shareable || !storage)
+            return storage;
+        return make_shared<vector<T, Alloc>>(*storage);
+    }
+
+public:
+    using value_type = T;
+
+    CowBuffer() = default;
+
+    template<typename It>
+    CowBuffer(It first, It last)
+        : storage(make_shared<vector<T, Alloc>>(first, last))
+    {
+    }
+
+    CowBuffer(const CowBuffer& other)
+        : storage(other.share())
+    {
+    }
+
+    CowBuffer(CowBuffer&& other) noexcept = default;
+
+    CowBuffer& operator=(const CowBuffer& other)
+    {
+        if (this != &other)
+        {
+            storage = other.share();
+            shareable = true;
+        }
+        return *this;
+    }
+
+    CowBuffer& operator=(CowBuffer&& other) noexcept = default;
+
+    size_t size() const
+    {
+        return storage ? storage->size() : 0;
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    const T* data() const
+    {
+        return storage ? storage->data() : nullptr;
+    }
+
+    T* data()
+    {
+        detach();
+        return storage->data();
+    }
+
+    const T& operator[](size_t i) const
+    {
+        return (*storage)[i];
+    }
+
+    T& operator[](size_t i)
+    {
+        detach();
+        return (*storage)[i];
+    }
+
+    typename vector<T, Alloc>::const_iterator begin() const
+    {
+        return static_cast<const vector<T, Alloc>&>(*this).begin();
+    }
+
+    typename vector<T, Alloc>::const_iterator end() const
+    {
+        return static_cast<const vector<T, Alloc>&>(*this).end();
+    }
+
+    typename vector<T, Alloc>::iterator begin()
+    {
+        detach();
+        return storage->begin();
+    }
+
+    typename vector<T, Alloc>::iterator end()
+    {
+        detach();
+        return storage->end();
+    }
+
+    void resize(size_t n, const T& value = T())
+    {
+        detach();
+        storage->resize(n, value);
+    }
+
+    operator const vector<T, Alloc>&() const
+    {
+        static const vector<T, Alloc> no_data;
+        return storage ? *storage : no_data;
+    }
+
+    void mark_unshareable()
+    {
+        shareable = false;
+    }
+
+    // Nombre de tenseurs partageant ce buffer
+    long use_count() const
+    {
+        return storage.use_count();
+    }
+};
+
+#if TENSOR_COPY_ON_WRITE
+template<typename T, typename Alloc>
+using TensorBuffer = CowBuffer<T, Alloc>;
+#else
+template<typename T, typename Alloc>
+using TensorBuffer = vector<T, Alloc>;
+#endif
+
+/// Alloc : allocateur du buffer (AlignedAllocator<T> par défaut pour les types arithmétiques,
+/// ArenaAllocator<T> pour des temporaires rendus en bloc par TensorArena::local().reset()).
+template<typename T, typename Alloc>
+class Tensor
+{
+    template<typename U> friend class TensorView;
+    template<typename U, typename A> friend class Tensor;
+private:
+    TensorBuffer<T, Alloc> buffer;  // vector<T, Alloc>, ou CowBuffer<T, Alloc> avec TENSOR_COPY_ON_WRITE
+    vector<size_t> shape;
+    vector<size_t> strides;
+    shared_ptr<const Metric<T>> metric;  // 🔥 métrique partagée, immuable
+
+
+    void compute_strides()
+    {
+        strides.resize(shape.size());
+        size_t stride = 1;
+        for (int i = shape.size() - 1; i >= 0; --i)
+        {
+            strides[i] = stride;
+            stride *= shape[i];
+        }
+    }
+
+    size_t flatten_index(const vector<size_t>& indices) const
+    {
+        if (indices.size() != shape.size())
+            throw runtime_error("Index dimension mismatch");
+
+        size_t idx = 0;
+        for (size_t i = 0; i < shape.size(); ++i)
+        {
+            if (indices[i] >= shape[i])
+                throw out_of_range("Index out of bounds");
+            idx += indices[i] * strides[i];
+        }
+        return idx;
+    }
+
+
+    // Indice plat sans allocation ni vérification
+    template<typename... Args>
+    size_t offset_of(Args... args) const
+    {
+        size_t idx = 0, d = 0;
+        ((idx += static_cast<size_t>(args) * strides[d++]), ...);
+        return idx;
+    }
+
+    size_t offset_of(const vector<size_t>& indices) const
+    {
+        size_t idx = 0;
+        for (size_t i = 0; i < indices.size(); ++i)
+            idx += indices[i] * strides[i];
+        return idx;
+    }
+
+    template<typename... Args>
+    void check_indices(Args... args) const
+    {
+        if (sizeof...(Args) != shape.size())
+            throw runtime_error("Index dimension mismatch");
+        size_t d = 0;
+        if (!((static_cast<size_t>(args) < shape[d++]) && ...))
+            throw out_of_range("Index out of bounds");
+    }
+
+    // buffer op= s (float / double), par morceaux répartis sur le pool de threads
+    void apply_scalar(tensor_kernels::ElementOp op, T s)
+    {
+        T* p = buffer.data();
+        tensor_kernels::parallel_for(0, buffer.size(), tensor_kernels::PARALLEL_GRAIN, [&](size_t lo, size_t hi)
+        {
+            tensor_kernels::simd<T>().binary_scalar(op, p + lo, s, p + lo, hi - lo);
+        });
+    }
+
+public:
+    Tensor() = default;
+
+    Tensor(const vector<size_t>& shape_, T init_val = T())
+        : shape(shape_)
+    {
+        size_t total = 1;
+        for (auto d : shape) total *= d;
+        buffer.resize(total, init_val);
+        compute_strides();
+    }
+
+    // Constructeur par liste d'initialisation
+    Tensor(std::initializer_list<size_t> shape_, T init_val = T())
+        : shape(shape_)
+    {
+        size_t total = 1;
+        for (auto d : shape) total *= d;
+        buffer.resize(total, init_val);
+        compute_strides();
+    }
+
+    // Constructeur avec form
+
+    Tensor(const vector<size_t>& shape_, const vector<T>& values)
+        : buffer(values.begin(), values.end()), shape(shape_)
+    {
+        size_t total = 1;
+        for (auto d : shape) total *= d;
+        if (buffer.size() != total)
+            throw std::runtime_error("Data size does not match shape");
+
+        compute_strides();
+    }
+
+    // La métrique est partagée, pas recopiée
+    Tensor(const Tensor& other)
+        : buffer(other.buffer), shape(other.shape), strides(other.strides), metric(other.metric)
+    {
+        TENSOR_PROFILE_OP("copy", shape);
+#if TENSOR_PROFILE
+        // Accès const : data() non const détacherait le buffer partagé (copie à l'écriture)
+        if (std::as_const(buffer).data() != other.buffer.data())
+            TENSOR_PROFILE_COPY(buffer.size() * sizeof(T));
+#endif
+    }
+
+    Tensor(Tensor&& other) noexcept
+        : buffer(std::move(other.buffer)), shape(std::move(other.shape)), strides(std::move(other.strides)), metric(std::move(other.metric))
+    {
+    }
+
+    // Copie depuis un tenseur d'un autre allocateur (Tensor<T, ArenaAllocator<T>> <-> Tensor<T>)
+    template<typename A2>
+    Tensor(const Tensor<T, A2>& other)
+        : buffer(other.buffer.begin(), other.buffer.end()), shape(other.shape), strides(other.strides), metric(other.metric)
+    {
+        TENSOR_PROFILE_OP("copy", shape);
+        TENSOR_PROFILE_COPY(buffer.size() * sizeof(T));
+    }
+
+    // Évaluation d'une expression en une seule boucle (Tensor D = A * 2.0 + B;)
+    template<typename E>
+    Tensor(const TensorExpression<E, T>& expr)
+        : shape(expr.self().get_shape())
+    {
+        TENSOR_PROFILE_OP("evaluate", shape);
+        TENSOR_PROFILE_FLOPS(expr.self().size() * expression_ops<E>::value);
+        buffer.resize(expr.self().size());
+        evaluate_into<StoreMode::Assign>(expr.self(), shape, buffer.data());
+        compute_strides();
+    }
+
+    // Matérialisation implicite d'une vue (Tensor X = A.permute(...);)
+    Tensor(const TensorView<T>& view)
+        : Tensor(view.contiguous())
+    {
+    }
+
+    Tensor(const TensorView<const T>& view)
+        : Tensor(view.contiguous())
+    {
+    }
+
+
+    ~Tensor() = default;
+
+    // Surcharge de l'opérateur << pour afficher le tenseur
+    friend ostream& operator<<(ostream& os, const Tensor& tensor)
+    {
+        os << "Tensor (shape: ";
+        for (size_t i = 0; i < tensor.shape.size(); ++i)
+        {
+            os << tensor.shape[i];
+            if (i != tensor.shape.size() - 1) os << " x ";
+        }
+        os << "):\n";
+
+        size_t total = tensor.size();
+        for (size_t i = 0; i < total; ++i)
+        {
+            vector<size_t> indices = tensor.flatten_to_indices(i, tensor.shape);
+            os << "(";
+            for (size_t j = 0; j < indices.size(); ++j)
+            {
+                os << indices[j];
+                if (j != indices.size() - 1) os << ", ";
+            }
+            os << ") = " << tensor.buffer[i] << "\n";
+        }
+        return os;
+    }
+
+    // Accès sans allocation ; vérifié seulement si TENSOR_BOUNDS_CHECK (voir at())
+    template<typename... Args>
+    T& operator()(Args... args)
+    {
+#if TENSOR_BOUNDS_CHECK
+        check_indices(args...);
+#endif
+        return buffer[offset_of(args...)];
+    }
+
+    template<typename... Args>
+    const T& operator()(Args... args) const
+    {
+#if TENSOR_BOUNDS_CHECK
+        check_indices(args...);
+#endif
+        return buffer[offset_of(args...)];
+    }
+
+    // Accès toujours vérifié (rang et bornes)
+    template<typename... Args>
+    T& at(Args... args)
+    {
+        check_indices(args...);
+        return buffer[offset_of(args...)];
+    }
+
+    template<typename... Args>
+    const T& at(Args... args) const
+    {
+        check_indices(args...);
+        return buffer[offset_of(args...)];
+    }
+
+    T& at(const vector<size_t>& indices)
+    {
+        return buffer[flatten_index(indices)];
+    }
+
+    const T& at(const vector<size_t>& indices) const
+    {
+        return buffer[flatten_index(indices)];
+    }
+
+    // Pointeur brut sur les éléments (row-major, contigus)
+    T* data()
+    {
+#if TENSOR_COPY_ON_WRITE
+        buffer.mark_unshareable();
+#endif
+        return buffer.data();
+    }
+
+    const T* data() const
+    {
+        return buffer.data();
+    }
+
+    // Opérateur d'affectation par déplacement
+    Tensor& operator=(Tensor&& other) noexcept
+    {
+        if (this != &other)
+        {
+            buffer = std::move(other.buffer);
+            shape = std::move(other.shape);
+            strides = std::move(other.strides);
+            metric = std::move(other.metric);
+        }
+        return *this;
+    }
+
+
+    Tensor& operator=(const Tensor& other)
+    {
+        if (this != &other)
+        {
+            TENSOR_PROFILE_OP("copy", other.shape);
+            buffer = other.buffer;
+#if TENSOR_PROFILE
+            if (std::as_const(buffer).data() != other.buffer.data())
+                TENSOR_PROFILE_COPY(buffer.size() * sizeof(T));
+#endif
+            shape = other.shape;
+            strides = other.strides;
+            metric = other.metric;
+        }
+        return *this;
+    }
+
+    // A = A * 2.0 + B est sûr : chaque élément ne dépend que des éléments de même rang.
+    // Comme avec un Tensor temporaire, le résultat n'a pas de métrique.
+    template<typename E>
+    Tensor& operator=(const TensorExpression<E, T>& expr)
+    {
+        const E& e = expr.self();
+        if (e.size() != buffer.size())
+            return *this = Tensor(expr);
+
+        TENSOR_PROFILE_OP("evaluate", e.get_shape());
+        TENSOR_PROFILE_FLOPS(e.size() * expression_ops<E>::value);
+        // Même nombre d'éléments : le buffer est réutilisé quelle que soit la nouvelle forme ({2, 3} <- {3, 2}).
+        // Si *this figure dans l'expression, le broadcasting ne peut lui ajouter que des dimensions 1 :
+        // chaque élément est lu au rang où il est écrit.
+        vector<size_t> new_shape = e.get_shape();
+        evaluate_into<StoreMode::Assign>(e, new_shape, buffer.data());
+        if (shape != new_shape)
+        {
+            shape = new_shape;
+            compute_strides();
+        }
+        metric.reset();
+        return *this;
+    }
+
+    // Opérateurs composés en place ; l'opérande est diffusé (broadcast) sur la forme de *this
+    template<typename X, typename std::enable_if<is_tensor_operand<X>::value, int>::type = 0>
+    Tensor& operator+=(const X& other)
+    {
+        TENSOR_PROFILE_OP("operator+=", shape);
+        TENSOR_PROFILE_FLOPS(buffer.size() * (1 + expression_ops<typename std::decay<decltype(as_expression(other))>::type>::value));
+        evaluate_into<StoreMode::Add>(as_expression(other), shape, buffer.data());
+        return *this;
+    }
+
+    template<typename X, typename std::enable_if<is_tensor_operand<X>::value, int>::type = 0>
+    Tensor& operator-=(const X& other)
+    {
+        TENSOR_PROFILE_OP("operator-=", shape);
+        TENSOR_PROFILE_FLOPS(buffer.size() * (1 + expression_ops<typename std::decay<decltype(as_expression(other))>::type>::value));
+        evaluate_into<StoreMode::Sub>(as_expression(other), shape, buffer.data());
+        return *this;
+    }
+
+    template<typename X, typename std::enable_if<is_tensor_operand<X>::value, int>::type = 0>
+    Tensor& operator*=(const X& other)
+    {
+        TENSOR_PROFILE_OP("operator*=", shape);
+        TENSOR_PROFILE_FLOPS(buffer.size() * (1 + expression_ops<typename std::decay<decltype(as_expression(other))>::type>::value));
+        evaluate_into<StoreMode::Mul>(as_expression(other), shape, buffer.data());
+        return *this;
+    }
+
+    template<typename X, typename std::enable_if<is_tensor_operand<X>::value, int>::type = 0>
+    Tensor& operator/=(const X& other)
+    {
+        TENSOR_PROFILE_OP("operator/=", shape);
+        TENSOR_PROFILE_FLOPS(buffer.size() * (1 + expression_ops<typename std::decay<decltype(as_expression(other))>::type>::value));
+        evaluate_into<StoreMode::Div>(as_expression(other), shape, buffer.data());
+        return *this;
+    }
+
+    template<typename U, typename std::enable_if<!is_tensor_operand<U>::value, int>::type = 0>
+    Tensor& operator+=(const U& scalar)
+    {
+        TENSOR_PROFILE_OP("operator+=", shape);
+        TENSOR_PROFILE_FLOPS(buffer.size());
+        T s = static_cast<T>(scalar);
+        if constexpr (tensor_kernels::is_simd_type<T>::value)
+            apply_scalar(tensor_kernels::ElementOp::Add, s);
+        else
+            for (auto& v : buffer) v = v + s;
+        return *this;
+    }
+
+    template<typename U, typename std::enable_if<!is_tensor_operand<U>::value, int>::type = 0>
+    Tensor& operator-=(const U& scalar)
+    {
+        TENSOR_PROFILE_OP("operator-=", shape);
+        TENSOR_PROFILE_FLOPS(buffer.size());
+        T s = static_cast<T>(scalar);
+        if constexpr (tensor_kernels::is_simd_type<T>::value)
+            apply_scalar(tensor_kernels::ElementOp::Sub, s);
+        else
+            for (auto& v : buffer) v = v - s;
+        return *this;
+    }
+
+    template<typename U, typename std::enable_if<!is_tensor_operand<U>::value, int>::type = 0>
+    Tensor& operator*=(const U& scalar)
+    {
+        TENSOR_PROFILE_OP("operator*=", shape);
+        TENSOR_PROFILE_FLOPS(buffer.size());
+        T s = static_cast<T>(scalar);
+        if constexpr (tensor_kernels::is_simd_type<T>::value)
+            apply_scalar(tensor_kernels::ElementOp::Mul, s);
+        else
+            for (auto& v : buffer) v = v * s;
+        return *this;
+    }
+
+    template<typename U, typename std::enable_if<!is_tensor_operand<U>::value, int>::type = 0>
+    Tensor& operator/=(const U& scalar)
+    {
+        TENSOR_PROFILE_OP("operator/=", shape);
+        TENSOR_PROFILE_FLOPS(buffer.size());
+        T s = static_cast<T>(scalar);
+        if constexpr (tensor_kernels::is_simd_type<T>::value)
+            apply_scalar(tensor_kernels::ElementOp::Div, s);
+        else
+            for (auto& v : buffer) v = v / s;
+        return *this;
+    }
+
+    size_t ndim() const
+    {
+        return shape.size();
+    }
+
+    const vector<size_t>& get_strides() const
+    {
+        return strides;
+    }
+
+    size_t size() const
+    {
+        return buffer.size();
+    }
+
+    T& operator()(const vector<size_t>& indices)
+    {
+#if TENSOR_BOUNDS_CHECK
+        return buffer[flatten_index(indices)];
+#else
+        return buffer[offset_of(indices)];
+#endif
+    }
+
+    const T& operator()(const vector<size_t>& indices) const
+    {
+#if TENSOR_BOUNDS_CHECK
+        return buffer[flatten_index(indices)];
+#else
+        return buffer[offset_of(indices)];
+#endif
+    }
+
+    T sum() const
+    {
+        TENSOR_PROFILE_OP("sum", shape);
+        TENSOR_PROFILE_FLOPS(buffer.size());
+        if constexpr (tensor_kernels::is_simd_type<T>::value)
+            return tensor_kernels::parallel_reduce(buffer.size(), tensor_kernels::PARALLEL_GRAIN, T(0), [this](size_t lo, size_t hi)
+            {
+                return tensor_kernels::simd<T>().sum(buffer.data() + lo, hi - lo);
+            }, std::plus<T>());
+        else
+            return accumulate(buffer.begin(), buffer.end(), T());
+    }
+
+    T pseudo_norm() const
+    {
+        TENSOR_PROFILE_OP("pseudo_norm", shape);
+        TENSOR_PROFILE_FLOPS(!metric ? 2 * buffer.size() : metric->get_kind() == MetricKind::Dense ? 2 * shape[0] * shape[0] : 2 * shape[0]);
+        if (!metric)
+        {
+            if constexpr (tensor_kernels::is_simd_type<T>::value)
+                return tensor_kernels::parallel_reduce(buffer.size(), tensor_kernels::PARALLEL_GRAIN, T(0), [this](size_t lo, size_t hi)
+                {
+                    return tensor_kernels::simd<T>().sum_squares(buffer.data() + lo, hi - lo);
+                }, std::plus<T>());
+            else
+                return std::accumulate(buffer.begin(), buffer.end(), T(0), [](T sum, T val) { return sum + val * val; });
+        }
+
+        const Tensor<T>& G = metric->tensor();
+        size_t dim = shape[0];
+        if (G.shape.size() != 2 || G.shape[0] < dim || G.shape[1] < dim)
+            throw std::runtime_error("Metric must be a square matrix matching the first dimension");
+        size_t ld = G.shape[1];
+        const T* g = G.buffer.data();
+
+        T norm_squared = 0.0;
+        switch (metric->get_kind())
+        {
+        case MetricKind::Identity:
+            if constexpr (tensor_kernels::is_simd_type<T>::value)
+                norm_squared = tensor_kernels::simd<T>().sum_squares(buffer.data(), dim);
+            else
+                for (size_t i = 0; i < dim; ++i)
+                    norm_squared += buffer[i] * buffer[i];
+            break;
+        case MetricKind::Diagonal:
+            for (size_t i = 0; i < dim; ++i)
+                norm_squared += g[i * ld + i] * buffer[i] * buffer[i];
+            break;
+        case MetricKind::Symmetric:
+            // x.G.x = sum_i g_ii x_i^2 + 2 sum_{i<j} g_ij x_i x_j
+            for (size_t i = 0; i < dim; ++i)
+            {
+                T off = T(0);
+                for (size_t j = i + 1; j < dim; ++j)
+                    off += g[i * ld + j] * buffer[j];
+                norm_squared += buffer[i] * (g[i * ld + i] * buffer[i] + T(2) * off);
+            }
+            break;
+        default:
+            for (size_t i = 0; i < dim; ++i)
+                for (size_t j = 0; j < dim; ++j)
+                    norm_squared += buffer[i] * g[i * ld + j] * buffer[j];
+            break;
+        }
+        return norm_squared;
+    }
+
+
+    void fill(T val)
+    {
+        std::fill(buffer.begin(), buffer.end(), val);
+    }
+
+
+    void print(bool detailed = false) const
+    {
+        if (detailed)
+        {
+            std::cout << "Shape: ";
+            if(shape.size()!=0)
+            {
+            for (auto s : shape) std::cout << s << " ";
+            std::cout << std::endl;
+            }
+            else cout<<"1d"<<endl;
+        }
+
+        if (shape.size() == 0)
+        {
+            // Tenseur scalaire
+            std::cout << buffer[0] << std::endl;
+        }
+        else if (shape.size() == 1)
+        {
+            // Vecteur 1D
+            for (size_t i = 0; i < shape[0]; ++i)
+                std::cout << (*this)({i}) << " ";
+            std::cout << std::endl;
+        }
+        else if (shape.size() == 2)
+        {
+            // Matrice 2D
+            for (size_t i = 0; i < shape[0]; ++i)
+            {
+                for (size_t j = 0; j < shape[1]; ++j)
+                {
+                    std::cout << (*this)({i, j}) << " ";
+                }
+                std::cout << std::endl;
+            }
+        }
+        else
+        {
+            // Tenseur >2D
+            printMatrixRepresentation(); // ou ta méthode personnalisée
+        }
+    }
+
+void reshape(const vector<size_t>& new_shape)
+    {
+        size_t new_total = std::accumulate(new_shape.begin(), new_shape.end(), size_t(1), std::multiplies<size_t>());
+        if (new_total != buffer.size()) throw runtime_error("Reshape size mismatch");
+        shape = new_shape;
+        compute_strides();
+    }
+
+    const vector<T, Alloc>& get_data() const
+    {
+        return buffer;
+    }
+ void set_metric(const Tensor<T>& metric_tensor)
+    {
+        metric = make_shared<const Metric<T>>(metric_tensor);
+    }
+
+    // Partage une métrique existante (aucune copie) : g = make_metric(eta); v.set_metric(g);
+    void set_metric(shared_ptr<const Metric<T>> shared_metric)
+    {
+        metric = std::move(shared_metric);
+    }
+
+    shared_ptr<const Metric<T>> get_shared_metric() const
+    {
+        return metric;
+    }
+
+    MetricKind get_metric_kind() const
+    {
+        return metric ? metric->get_kind() : MetricKind::Dense;
+    }
+
+    const Tensor<T>* get_metric() const
+    {
+        return metric ? &metric->tensor() : nullptr;
+    }
+
+    /// Sauvegarde binaire (format décrit dans Tenseurs_io.h) : en-tête, shape, strides,
+    /// éléments bruts alignés sur 64 octets, puis la métrique s'il y en a une
+    void save(const string& path) const
+    {
+        TENSOR_PROFILE_OP("save", shape);
+        const Tensor<T>* g = get_metric();
+        tensor_io::write_file(path, buffer.data(), shape, strides,
+                              g ? g->data() : nullptr, g ? g->get_shape() : vector<size_t>());
+    }
+
+    /// Chargement en mémoire : les éléments sont lus d'un bloc dans le buffer
+    static Tensor load(const string& path)
+    {
+        TENSOR_PROFILE_OP("load", vector<size_t>());
+        Tensor result;
+        vector<size_t> g_shape;
+        vector<T> g_data;
+        tensor_io::FileLayout layout = tensor_io::read_file(path, result.buffer, g_shape, g_data);
+
+        result.shape = layout.shape;
+        result.compute_strides();
+        if (layout.strides != result.strides)
+            result = TensorView<const T>(result.buffer.data(), layout.shape, layout.strides).contiguous();
+        if (layout.header.metric_offset)
+            result.set_metric(Tensor<T>(g_shape, g_data));
+        return result;
+    }
+
+    /// Projection du fichier sans le lire (démarrage immédiat, pages chargées au premier accès), en lecture seule
+    static MappedTensor<const T> mmap(const string& path)
+    {
+        return MappedTensor<const T>(path);
+    }
+
+    /// Projection en copie à l'écriture : les écritures restent privées au processus, le fichier n'est jamais modifié
+    static MappedTensor<T> mmap_copy_on_write(const string& path)
+    {
+        return MappedTensor<T>(path);
+    }
+
+
+    TensorView<T> view()
+    {
+#if TENSOR_COPY_ON_WRITE
+        buffer.mark_unshareable();
+#endif
+        return TensorView<T>(buffer.data(), shape, strides);
+    }
+
+    TensorView<const T> view() const
+    {
+        return TensorView<const T>(buffer.data(), shape, strides);
+    }
+
+    // Sur un temporaire la vue serait pendante : on renvoie une copie
+    TensorView<T> slice(const vector<tuple<size_t, size_t, size_t>>& slices) &
+    {
+        return view().slice(slices);
+    }
+
+    TensorView<const T> slice(const vector<tuple<size_t, size_t, size_t>>& slices) const &
+    {
+        return view().slice(slices);
+    }
+
+    Tensor slice(const vector<tuple<size_t, size_t, size_t>>& slices) &&
+    {
+        return view().slice(slices).contiguous();
+    }
+
+    TensorView<T> slice(const vector<tuple<size_t, ptrdiff_t, ptrdiff_t, size_t>>& slices) &
+    {
+        return view().slice(slices);
+    }
+
+    TensorView<const T> slice(const vector<tuple<size_t, ptrdiff_t, ptrdiff_t, size_t>>& slices) const &
+    {
+        return view().slice(slices);
+    }
+
+    Tensor slice(const vector<tuple<size_t, ptrdiff_t, ptrdiff_t, size_t>>& slices) &&
+    {
+        return view().slice(slices).contiguous();
+    }
+
+    Tensor take(size_t dim, const vector<size_t>& indices) const
+    {
+        return view().take(dim, indices);
+    }
+
+
+
+    void printMatrixRepresentation() const
+    {
+        for (size_t i = 0; i < shape[0]; ++i)
+        {
+            std::cout << "Slice " << i << " :\n";
+            for (size_t j = 0; j < shape[1]; ++j)
+            {
+                for (size_t k = 0; k < shape[2]; ++k)
+                {
+                    std::cout << (*this)({i, j, k}) << " ";
+                }
+                std::cout << std::endl;
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    vector<size_t> flatten_to_indices(size_t index, const vector<size_t>& other_shape) const
+    {
+        vector<size_t> indices(other_shape.size(), 0);
+        size_t remaining_index = index;
+
+        for (int i = other_shape.size() - 1; i >= 0; --i)
+        {
+            indices[i] = remaining_index % other_shape[i];
+            remaining_index /= other_shape[i];
+        }
+        return indices;
+    }
+
+
+    Tensor tensor_product(const Tensor& other) const
+    {
+        TENSOR_PROFILE_OP("tensor_product", shape);
+        TENSOR_PROFILE_FLOPS(buffer.size() * other.buffer.size());
+        // Nouvelle forme du tenseur résultant (Kronecker) : le rang le plus petit est complété par des 1
+        size_t nd = max(shape.size(), other.shape.size());
+        vector<size_t> shape_a(nd, 1), shape_b(nd, 1), new_shape(nd);
+        std::copy(shape.begin(), shape.end(), shape_a.begin());
+        std::copy(other.shape.begin(), other.shape.end(), shape_b.begin());
+        for (size_t k = 0; k < nd; ++k)
+            new_shape[k] = shape_a[k] * shape_b[k];
+
+        Tensor result(new_shape);
+        if (result.buffer.empty())
+            return result;
+        if (nd == 0)
+        {
+            result.buffer[0] = buffer[0] * other.buffer[0];
+            return result;
+        }
+
+        vector<size_t> strides_a(nd), strides_b(nd);
+        for (size_t k = nd, sa = 1, sb = 1; k-- > 0; sa *= shape_a[k], sb *= shape_b[k])
+        {
+            strides_a[k] = sa;
+            strides_b[k] = sb;
+        }
+
+        // Une ligne du résultat (dernier axe) est faite de shape_a.back() blocs a(i) * (ligne de other) :
+        // copies de blocs mises à l'échelle, lignes réparties sur le pool de threads
+        size_t last = nd - 1;
+        size_t da = shape_a[last], db = shape_b[last];
+        size_t row_len = da * db;
+        size_t rows = result.buffer.size() / row_len;
+        size_t grain = std::is_arithmetic<T>::value ? std::max<size_t>(1, tensor_kernels::PARALLEL_GRAIN / row_len) : rows;
+        tensor_kernels::parallel_for(0, rows, grain, [&](size_t r0, size_t r1)
+        {
+            for (size_t r = r0; r < r1; ++r)
+            {
+                size_t off_a = 0, off_b = 0;
+                for (size_t k = last, q = r; k-- > 0; q /= new_shape[k])
+                {
+                    size_t i = q % new_shape[k];
+                    off_a += (i / shape_b[k]) * strides_a[k];
+                    off_b += (i % shape_b[k]) * strides_b[k];
+                }
+
+                const T* row_a = buffer.data() + off_a;
+                const T* row_b = other.buffer.data() + off_b;
+                T* out = result.buffer.data() + r * row_len;
+                for (size_t ia = 0; ia < da; ++ia)
+                {
+                    if constexpr (tensor_kernels::is_simd_type<T>::value)
+                        tensor_kernels::simd<T>().binary_scalar(tensor_kernels::ElementOp::Mul, row_b, row_a[ia], out + ia * db, db);
+                    else
+                        for (size_t j = 0; j < db; ++j)
+                            out[ia * db + j] = row_a[ia] * row_b[j];
+                }
+            }
+        });
+
+        return result;
+    }
+
+    // Produit tensoriel paresseux : aucun élément n'est calculé avant l'accès
+    KroneckerView<T> tensor_product_view(const Tensor<T>& other) const
+    {
+        return KroneckerView<T>(*this, other);
+    }
+
+    TensorView<T> permute(const vector<size_t>& order) &
+    {
+        return view().permute(order);
+    }
+
+    TensorView<const T> permute(const vector<size_t>& order) const &
+    {
+        return view().permute(order);
+    }
+
+    Tensor permute(const vector<size_t>& order) &&
+    {
+        return view().permute(order).contiguous();
+    }
+
+    const vector<size_t>& get_shape() const
+    {
+        return shape;
+    }
+
+
+    Tensor contract(size_t axis1, size_t axis2) const
+    {
+        TENSOR_PROFILE_OP("contract", shape);
+        if (axis1 >= shape.size() || axis2 >= shape.size())
+            throw std::runtime_error("Invalid axis");
+
+        if (axis1 == axis2)
+            throw std::runtime_error("Cannot contract the same axis");
+
+        if (shape[axis1] != shape[axis2])
+            throw std::runtime_error("Cannot contract axes with different sizes");
+        TENSOR_PROFILE_FLOPS(buffer.size() / shape[axis1]);
+
+        // Axes restants : forme et pas dans le tenseur source
+        vector<size_t> new_shape, src_strides;
+        for (size_t i = 0; i < shape.size(); ++i)
+        {
+            if (i != axis1 && i != axis2)
+            {
+                new_shape.push_back(shape[i]);
+                src_strides.push_back(strides[i]);
+            }
+        }
+
+        // Résultat initialisé à zéro (même si new_shape est vide)
+        Tensor result(new_shape, T(0));
+
+        // Somme sur la diagonale (k, k) : un pas constant strides[axis1] + strides[axis2].
+        // Le dernier axe restant forme des lignes de L éléments, accumulées pour chaque k
+        // (boucle interne contiguë quand cet axe est le dernier du tenseur) ; lignes réparties sur le pool.
+        const size_t dim = shape[axis1];
+        const size_t diag_stride = strides[axis1] + strides[axis2];
+        const size_t L = new_shape.empty() ? 1 : new_shape.back();
+        const size_t step = new_shape.empty() ? 0 : src_strides.back();
+        const size_t n_rows = result.buffer.size() / std::max<size_t>(L, 1);
+        const size_t outer = new_shape.empty() ? 0 : new_shape.size() - 1;
+        const T* src = buffer.data();
+        T* dst = result.buffer.data();
+
+        size_t grain = std::is_arithmetic<T>::value ? std::max<size_t>(1, tensor_kernels::PARALLEL_GRAIN / std::max<size_t>(1, L * dim)) : n_rows;
+        tensor_kernels::parallel_for(0, n_rows, grain, [&](size_t r0, size_t r1)
+        {
+            // Indices des axes restants (sauf le dernier) de la ligne r0, puis compteur
+            vector<size_t> idx(outer);
+            size_t base = 0;
+            for (size_t a = outer, r = r0; a-- > 0; r /= new_shape[a])
+            {
+                idx[a] = r % new_shape[a];
+                base += idx[a] * src_strides[a];
+            }
+            for (size_t r = r0; r < r1; ++r)
+            {
+                T* out = dst + r * L;
+                for (size_t k = 0; k < dim; ++k)
+                {
+                    const T* in = src + base + k * diag_stride;
+                    if (step == 1)
+                        for (size_t j = 0; j < L; ++j)
+                            out[j] += in[j];
+                    else
+                        for (size_t j = 0; j < L; ++j)
+                            out[j] += in[j * step];
+                }
+                for (size_t a = outer; a-- > 0;)
+                {
+                    base += src_strides[a];
+                    if (++idx[a] < new_shape[a])
+                        break;
+                    base -= idx[a] * src_strides[a];
+                    idx[a] = 0;
+                }
+            }
+        });
+
+        return result;
+    }
+
+    TensorView<T> flatten() &
+    {
+        return view().flatten();
+    }
+
+    TensorView<const T> flatten() const &
+    {
+        return view().flatten();
+    }
+
+    Tensor flatten() &&
+    {
+        Tensor result(std::move(*this));
+        result.reshape({result.buffer.size()});
+        return result;
+    }
+
+
+    Tensor contract_with(const Tensor& B, size_t axis_A, size_t axis_B) const
+    {
+        TENSOR_PROFILE_OP("contract_with", shape);
+        if (axis_A >= shape.size() || axis_B >= B.shape.size())
+            throw std::runtime_error("Invalid contraction axes");
+
+        size_t dim = shape[axis_A];
+        if (dim != B.shape[axis_B])
+            throw std::runtime_error("Mismatched dimensions for contraction");
+
+        bool use_metric = (metric != nullptr);
+        if (use_metric)
+        {
+            if (metric->tensor().get_shape().size() != 2 || metric->tensor().get_shape()[0] != dim || metric->tensor().get_shape()[1] != dim)
+                throw std::runtime_error("Metric must be a square matrix matching contraction dimension");
+        }
+
+        // Compute shape of result
+        std::vector<size_t> new_shape;
+        for (size_t i = 0; i < shape.size(); ++i)
+            if (i != axis_A)
+                new_shape.push_back(shape[i]);
+
+        for (size_t i = 0; i < B.shape.size(); ++i)
+            if (i != axis_B)
+                new_shape.push_back(B.shape[i]);
+
+        Tensor result(new_shape, T{});
+        TENSOR_PROFILE_FLOPS(2 * result.size() * dim);
+
+        // Réduction à un produit matriciel : A -> (M x dim), axe contracté en dernier,
+        // B -> (dim x N), axe contracté en premier, puis GEMM bloqué
+        vector<size_t> order_A, order_B;
+        for (size_t i = 0; i < shape.size(); ++i)
+            if (i != axis_A)
+                order_A.push_back(i);
+        order_A.push_back(axis_A);
+        order_B.push_back(axis_B);
+        for (size_t i = 0; i < B.shape.size(); ++i)
+            if (i != axis_B)
+                order_B.push_back(i);
+
+        size_t M = 1, N = 1;
+        for (size_t i = 0; i < shape.size(); ++i)
+            if (i != axis_A) M *= shape[i];
+        for (size_t i = 0; i < B.shape.size(); ++i)
+            if (i != axis_B) N *= B.shape[i];
+
+        // Une vue déjà contiguë est utilisée telle quelle, sinon on la matérialise
+        TensorView<const T> view_A = view().permute(order_A);
+        TensorView<const T> view_B = B.view().permute(order_B);
+        Tensor packed_A, packed_B;
+        const T* ptr_A = buffer.data();
+        const T* ptr_B = B.buffer.data();
+        if (!view_A.is_contiguous())
+        {
+            packed_A = view_A.contiguous();
+            ptr_A = packed_A.buffer.data();
+        }
+        if (!view_B.is_contiguous())
+        {
+            packed_B = view_B.contiguous();
+            ptr_B = packed_B.buffer.data();
+        }
+
+        // Avec métrique : B' = g . B, puis A . B'
+        // identité : rien à faire ; diagonale : mise à l'échelle des lignes O(dim N) ; sinon GEMM
+        Tensor metric_B;
+        if (use_metric && metric->get_kind() != MetricKind::Identity)
+        {
+            metric_B = Tensor({dim, N});
+            const T* g = metric->data();
+            if (metric->get_kind() == MetricKind::Diagonal)
+            {
+                for (size_t k = 0; k < dim; ++k)
+                {
+                    T gkk = g[k * dim + k];
+                    for (size_t n = 0; n < N; ++n)
+                        metric_B.buffer[k * N + n] = gkk * ptr_B[k * N + n];
+                }
+            }
+            else
+            {
+                tensor_kernels::gemm(dim, N, dim, g, dim, ptr_B, N, metric_B.buffer.data(), N);
+            }
+            ptr_B = metric_B.buffer.data();
+        }
+
+        tensor_kernels::gemm(M, N, dim, ptr_A, dim, ptr_B, N, result.buffer.data(), N);
+
+        return result;
+    }
+
+    /// ----------------------------------------------------------------
+    /// Opérations par lots : l'axe 0 numérote des tenseurs indépendants de même forme,
+    /// traités en un seul passage (pas de Tensor ni de validation par élément)
+    /// ----------------------------------------------------------------
+
+    /// Pseudo-norme de chaque vecteur du dernier axe : {N, d} -> {N}, r[n] = x_n . g . x_n,
+    /// avec la métrique du tenseur (d x d) ou l'identité
+    Tensor batched_pseudo_norm() const
+    {
+        return batched_pseudo_norm(metric);
+    }
+
+    /// Même calcul avec une métrique partagée donnée : v.batched_pseudo_norm(make_metric(eta))
+    Tensor batched_pseudo_norm(const shared_ptr<const Metric<T>>& g) const
+    {
+        TENSOR_PROFILE_OP("batched_pseudo_norm", shape);
+        if (shape.size() < 2)
+            throw std::runtime_error("Batched operations need a leading batch axis");
+        size_t d = shape.back();
+        if (g && (g->tensor().get_shape().size() != 2 || g->tensor().get_shape()[0] != d || g->tensor().get_shape()[1] != d))
+            throw std::runtime_error("Metric must be a square matrix matching the last dimension");
+
+        Tensor result(vector<size_t>(shape.begin(), shape.end() - 1));
+        size_t rows = result.size();
+        MetricKind kind = g ? g->get_kind() : MetricKind::Identity;
+        TENSOR_PROFILE_FLOPS(rows * (kind == MetricKind::Identity ? 2 * d : kind == MetricKind::Diagonal ? 3 * d : 2 * d * d + 2 * d));
+
+        // identité : somme des carrés ; diagonale : poids par composante ; sinon forme quadratique complète
+        vector<T> diag;
+        const T* full = nullptr;
+        if (kind == MetricKind::Diagonal)
+        {
+            diag.resize(d);
+            for (size_t k = 0; k < d; ++k)
+                diag[k] = g->data()[k * d + k];
+        }
+        else if (kind != MetricKind::Identity)
+            full = g->data();
+
+        tensor_kernels::batched_quadratic(rows, d, buffer.data(), diag.empty() ? nullptr : diag.data(), full, result.buffer.data());
+        return result;
+    }
+
+    /// Produit matrice-vecteur par lots : this {N, d} ; M {m, d} partagée par tous les vecteurs,
+    /// ou {N, m, d} (une matrice par vecteur) -> {N, m}
+    Tensor batched_matvec(const Tensor& M) const
+    {
+        TENSOR_PROFILE_OP("batched_matvec", shape);
+        if (shape.size() != 2)
+            throw std::runtime_error("batched_matvec expects a {N, d} tensor");
+        size_t n = shape[0], d = shape[1];
+        bool shared = M.shape.size() == 2;
+        if (!(shared || (M.shape.size() == 3 && M.shape[0] == n)) || M.shape.back() != d)
+            throw std::runtime_error("batched_matvec expects a {m, d} or {N, m, d} matrix");
+        size_t m = M.shape[M.shape.size() - 2];
+
+        Tensor result({n, m});
+        TENSOR_PROFILE_FLOPS(2 * n * m * d);
+        if (shared && m * d <= 64)
+        {
+            // Petite matrice (4x4 de Lorentz, rotation 3x3, ...) : elle reste en cache, produits scalaires par vecteur
+            tensor_kernels::batched_gemm(n, m, 1, d, M.buffer.data(), 0, buffer.data(), d, result.buffer.data(), m);
+        }
+        else if (shared)
+        {
+            // Y = X . M^T : un seul GEMM sur tous les vecteurs
+            vector<T> mt(d * m);
+            for (size_t i = 0; i < m; ++i)
+                for (size_t k = 0; k < d; ++k)
+                    mt[k * m + i] = M.buffer[i * d + k];
+            tensor_kernels::gemm(n, m, d, buffer.data(), d, mt.data(), m, result.buffer.data(), m);
+        }
+        else
+            tensor_kernels::batched_gemm(n, m, 1, d, M.buffer.data(), m * d, buffer.data(), d, result.buffer.data(), m);
+        return result;
+    }
+
+    /// contract_with appliqué à chaque élément : A {N, ...} et B {N, ...}, axes comptés sans l'axe de lot.
+    /// Résultat {N, axes restants de A..., axes restants de B...}. La métrique de A s'applique comme
+    /// dans contract_with. Pour un opérateur partagé (sans axe de lot), contract_with(B, axis_A + 1, axis_B)
+    /// fait déjà un seul GEMM sur tout le lot.
+    Tensor batched_contract_with(const Tensor& B, size_t axis_A, size_t axis_B) const
+    {
+        TENSOR_PROFILE_OP("batched_contract_with", shape);
+        if (shape.empty() || B.shape.empty() || shape[0] != B.shape[0])
+            throw std::runtime_error("Batched operands need the same leading batch axis");
+        if (axis_A + 1 >= shape.size() || axis_B + 1 >= B.shape.size())
+            throw std::runtime_error("Invalid contraction axes");
+
+        size_t batch = shape[0];
+        size_t dim = shape[axis_A + 1];
+        if (dim != B.shape[axis_B + 1])
+            throw std::runtime_error("Mismatched dimensions for contraction");
+        if (metric && (metric->tensor().get_shape().size() != 2 || metric->tensor().get_shape()[0] != dim || metric->tensor().get_shape()[1] != dim))
+            throw std::runtime_error("Metric must be a square matrix matching contraction dimension");
+
+        // Chaque élément : A -> (M x dim), B -> (dim x N), comme contract_with, sur tout le lot à la fois
+        vector<size_t> new_shape{batch}, order_A{0}, order_B{0, axis_B + 1};
+        size_t M = 1, N = 1;
+        for (size_t i = 1; i < shape.size(); ++i)
+            if (i != axis_A + 1)
+            {
+                order_A.push_back(i);
+                new_shape.push_back(shape[i]);
+                M *= shape[i];
+            }
+        order_A.push_back(axis_A + 1);
+        for (size_t i = 1; i < B.shape.size(); ++i)
+            if (i != axis_B + 1)
+            {
+                order_B.push_back(i);
+                new_shape.push_back(B.shape[i]);
+                N *= B.shape[i];
+            }
+
+        Tensor result(new_shape);
+        TENSOR_PROFILE_FLOPS(2 * result.size() * dim);
+
+        TensorView<const T> view_A = view().permute(order_A);
+        TensorView<const T> view_B = B.view().permute(order_B);
+        Tensor packed_A, packed_B;
+        const T* ptr_A = buffer.data();
+        const T* ptr_B = B.buffer.data();
+        if (!view_A.is_contiguous())
+        {
+            packed_A = view_A.contiguous();
+            ptr_A = packed_A.buffer.data();
+        }
+        if (!view_B.is_contiguous())
+        {
+            packed_B = view_B.contiguous();
+            ptr_B = packed_B.buffer.data();
+        }
+
+        // Avec métrique : B'[b] = g . B[b] (g partagé : pas nul)
+        Tensor metric_B;
+        if (metric && metric->get_kind() != MetricKind::Identity)
+        {
+            metric_B = Tensor({batch, dim, N});
+            const T* g = metric->data();
+            if (metric->get_kind() == MetricKind::Diagonal)
+            {
+                for (size_t b = 0; b < batch; ++b)
+                    for (size_t k = 0; k < dim; ++k)
+                    {
+                        T gkk = g[k * dim + k];
+                        const T* src = ptr_B + (b * dim + k) * N;
+                        T* dst = metric_B.buffer.data() + (b * dim + k) * N;
+                        for (size_t j = 0; j < N; ++j)
+                            dst[j] = gkk * src[j];
+                    }
+            }
+            else
+                tensor_kernels::batched_gemm(batch, dim, N, dim, g, 0, ptr_B, dim * N, metric_B.buffer.data(), dim * N);
+            ptr_B = metric_B.buffer.data();
+        }
+
+        tensor_kernels::batched_gemm(batch, M, N, dim, ptr_A, M * dim, ptr_B, dim * N, result.buffer.data(), M * N);
+        return result;
+    }
+
+    Tensor contract_with_metric(size_t axis1, size_t axis2) const
+    {
+        TENSOR_PROFILE_OP("contract_with_metric", shape);
+        if (axis1 >= shape.size() || axis2 >= shape.size())
+            throw std::runtime_error("Invalid axis indices");
+
+        if (axis1 == axis2)
+            throw std::runtime_error("Cannot contract the same axis");
+
+        if (shape[axis1] != shape[axis2])
+            throw std::runtime_error("Axes must have the same dimension");
+
+        size_t dim = shape[axis1];
+        if (metric && (metric->tensor().get_shape().size() != 2 || metric->tensor().get_shape()[0] != dim || metric->tensor().get_shape()[1] != dim))
+            throw std::runtime_error("Metric must be a square matrix matching contraction dimension");
+
+        // Sans métrique : identité, sans construire de matrice
+        MetricKind kind = metric ? metric->get_kind() : MetricKind::Identity;
+        const T* g = metric ? metric->data() : nullptr;
+
+        // Nouvelle forme sans les axes contractés
+        std::vector<size_t> new_shape, rest_strides;
+        for (size_t i = 0; i < shape.size(); ++i)
+        {
+            if (i != axis1 && i != axis2)
+            {
+                new_shape.push_back(shape[i]);
+                rest_strides.push_back(strides[i]);
+            }
+        }
+
+        Tensor result(new_shape, T(0));
+        TENSOR_PROFILE_FLOPS(2 * result.size() * (kind == MetricKind::Dense ? dim * dim : dim));
+        size_t s1 = strides[axis1], s2 = strides[axis2];
+        size_t nd = new_shape.size();
+
+        // Sorties réparties sur le pool de threads (types arithmétiques), chaque morceau
+        // repart de son propre compteur
+        size_t work = (kind == MetricKind::Identity || kind == MetricKind::Diagonal) ? dim : dim * dim;
+        size_t grain = std::is_arithmetic<T>::value ? std::max<size_t>(1, tensor_kernels::PARALLEL_GRAIN / std::max<size_t>(1, work)) : result.buffer.size();
+        tensor_kernels::parallel_for(0, result.buffer.size(), grain, [&](size_t r0, size_t r1)
+        {
+            std::vector<size_t> idx(nd, 0);
+            size_t offset = 0;
+            for (size_t d = nd, r = r0; d-- > 0; r /= new_shape[d])
+            {
+                idx[d] = r % new_shape[d];
+                offset += idx[d] * rest_strides[d];
+            }
+
+            for (size_t r = r0; r < r1; ++r)
+            {
+                T sum = T(0);
+                if (kind == MetricKind::Identity)
+                {
+                    for (size_t k = 0; k < dim; ++k)
+                        sum = sum + buffer[offset + k * (s1 + s2)];
+                }
+                else if (kind == MetricKind::Diagonal)
+                {
+                    for (size_t k = 0; k < dim; ++k)
+                        sum = sum + buffer[offset + k * (s1 + s2)] * g[k * dim + k];
+                }
+                else
+                {
+                    for (size_t k = 0; k < dim; ++k)
+                        for (size_t l = 0; l < dim; ++l)
+                            sum = sum + buffer[offset + k * s1 + l * s2] * g[k * dim + l];
+                }
+                result.buffer[r] = sum;
+
+                // Indice suivant du résultat (compteur incrémental)
+                for (size_t d = nd; d-- > 0;)
+                {
+                    if (++idx[d] < new_shape[d])
+                    {
+                        offset += rest_strides[d];
+                        break;
+                    }
+                    offset -= (new_shape[d] - 1) * rest_strides[d];
+                    idx[d] = 0;
+                }
+            }
+        });
+
+        return result;
+    }
+
+
+};
+
+/// Produit de Kronecker paresseux de deux tenseurs (même forme que A.tensor_product(B)).
+/// K(i) = A(i / dim_b) * B(i % dim_b) axe par axe, calculé à la demande.
+/// contract_with contracte K avec un tenseur sans jamais construire K :
+/// l'axe contracté de X est scindé en (dim_a, dim_b) et contracté successivement avec B puis A.
+/// La vue ne prolonge pas la durée de vie de A et B.
+template<typename T>
+class KroneckerView
+{
+    const Tensor<T>* a = nullptr;
+    const Tensor<T>* b = nullptr;
+    vector<size_t> shape_a, shape_b, shape;
+
+    // Opérande complété par des axes de taille 1, axe axis placé en dernier : matrice (reste x dim)
+    static Tensor<T> axis_last(const Tensor<T>& t, const vector<size_t>& padded, size_t axis)
+    {
+        vector<size_t> strides(padded.size()), order;
+        for (size_t k = padded.size(), s = 1; k-- > 0; s *= padded[k])
+            strides[k] = s;
+        for (size_t k = 0; k < padded.size(); ++k)
+            if (k != axis)
+                order.push_back(k);
+        order.push_back(axis);
+        return TensorView<const T>(t.data(), padded, strides).permute(order).contiguous();
+    }
+
+public:
+    KroneckerView(const Tensor<T>& A, const Tensor<T>& B)
+        : a(&A), b(&B)
+    {
+        size_t nd = max(A.ndim(), B.ndim());
+        shape_a.assign(nd, 1);
+        shape_b.assign(nd, 1);
+        shape.resize(nd);
+        std::copy(A.get_shape().begin(), A.get_shape().end(), shape_a.begin());
+        std::copy(B.get_shape().begin(), B.get_shape().end(), shape_b.begin());
+        for (size_t k = 0; k < nd; ++k)
+            shape[k] = shape_a[k] * shape_b[k];
+    }
+
+    const vector<size_t>& get_shape() const
+    {
+        return shape;
+    }
+
+    size_t ndim() const
+    {
+        return shape.size();
+    }
+
+    size_t size() const
+    {
+        return std::accumulate(shape.begin(), shape.end(), size_t(1), std::multiplies<size_t>());
+    }
+
+    T operator()(const vector<size_t>& indices) const
+    {
+        if (indices.size() != shape.size())
+            throw runtime_error("Index dimension mismatch");
+
+        size_t off_a = 0, off_b = 0;
+        for (size_t k = 0; k < shape.size(); ++k)
+        {
+            if (indices[k] >= shape[k])
+                throw out_of_range("Index out of bounds");
+            off_a = off_a * shape_a[k] + indices[k] / shape_b[k];
+            off_b = off_b * shape_b[k] + indices[k] % shape_b[k];
+        }
+        return a->data()[off_a] * b->data()[off_b];
+    }
+
+    template<typename... Args>
+    T operator()(Args... args) const
+    {
+        return (*this)(vector<size_t>{static_cast<size_t>(args)...});
+    }
+
+    // Matérialise le produit (A.tensor_product(B))
+    Tensor<T> contiguous() const
+    {
+        return a->tensor_product(*b);
+    }
+
+    /// Même convention que Tensor::contract_with : axes restants de K puis axes restants de X.
+    /// Coût O(taille du résultat * (dim_a + dim_b)) au lieu de O(taille de K * ...).
+    Tensor<T> contract_with(const Tensor<T>& X, size_t axis_K, size_t axis_X) const
+    {
+        if (axis_K >= shape.size() || axis_X >= X.ndim())
+            throw std::runtime_error("Invalid contraction axes");
+        if (shape[axis_K] != X.get_shape()[axis_X])
+            throw std::runtime_error("Mismatched dimensions for contraction");
+
+        size_t nd = shape.size();
+        size_t da = shape_a[axis_K], db = shape_b[axis_K];
+
+        // Résultat : axes restants de K, puis axes restants de X
+        vector<size_t> order_X(1, axis_X), x_rest, result_shape;
+        for (size_t k = 0; k < X.ndim(); ++k)
+        {
+            if (k != axis_X)
+            {
+                order_X.push_back(k);
+                x_rest.push_back(X.get_shape()[k]);
+            }
+        }
+        for (size_t k = 0; k < nd; ++k)
+            if (k != axis_K)
+                result_shape.push_back(shape[k]);
+        result_shape.insert(result_shape.end(), x_rest.begin(), x_rest.end());
+
+        // Axe contracté de taille nulle : somme vide, résultat nul comme Tensor::contract_with
+        if (da * db == 0)
+            return Tensor<T>(result_shape, T{});
+
+        size_t Ma = a->size() / da, Mb = b->size() / db, Mx = X.size() / (da * db);
+
+        // A -> (Ma x da), B -> (Mb x db), X -> (da x db x Mx)
+        Tensor<T> Am = axis_last(*a, shape_a, axis_K);
+        Tensor<T> Bm = axis_last(*b, shape_b, axis_K);
+        Tensor<T> Xm = X.view().permute(order_X).contiguous();
+
+        // Y[ia] = Bm . X[ia] (Mb x Mx), puis Z = Am . Y (Ma x Mb*Mx)
+        Tensor<T> Y(vector<size_t>{da, Mb, Mx});
+        for (size_t ia = 0; ia < da; ++ia)
+            tensor_kernels::gemm(Mb, Mx, db, Bm.data(), db, Xm.data() + ia * db * Mx, Mx, Y.data() + ia * Mb * Mx, Mx);
+
+        // Z : axes restants de A, axes restants de B, axes restants de X
+        vector<size_t> z_shape, order;
+        for (size_t k = 0; k < nd; ++k)
+            if (k != axis_K)
+                z_shape.push_back(shape_a[k]);
+        for (size_t k = 0; k < nd; ++k)
+            if (k != axis_K)
+                z_shape.push_back(shape_b[k]);
+        z_shape.insert(z_shape.end(), x_rest.begin(), x_rest.end());
+        Tensor<T> Z(z_shape);
+        tensor_kernels::gemm(Ma, Mb * Mx, da, Am.data(), da, Y.data(), Mb * Mx, Z.data(), Mb * Mx);
+
+        // Entrelacement (a_k, b_k) -> indice a_k * dim_b + b_k de K
+        for (size_t k = 0; k + 1 < nd; ++k)
+        {
+            order.push_back(k);
+            order.push_back(nd - 1 + k);
+        }
+        for (size_t k = 0; k < x_rest.size(); ++k)
+            order.push_back(2 * (nd - 1) + k);
+
+        Tensor<T> result = Z.view().permute(order).contiguous();
+        result.reshape(result_shape);
+        return result;
+    }
+
+    void print(bool detailed = false) const
+    {
+        contiguous().print(detailed);
+    }
+
+    friend ostream& operator<<(ostream& os, const KroneckerView& k)
+    {
+        return os << k.contiguous();
+    }
+};
+
+/// Tenseur métrique partagé et immuable.
+/// Une seule allocation par métrique distincte, partagée par shared_ptr entre tous les tenseurs
+/// qui la portent (copies comprises, et entre threads : rien n'est modifié après construction).
+/// La structure (MetricKind) est classée à la construction ; l'inverse et le déterminant sont
+/// calculés au premier appel seulement (std::call_once), puis servis depuis le cache.
+template<typename T>
+class Metric
+{
+    Tensor<T> g;
+    MetricKind kind;
+
+    mutable std::once_flag inverse_once, determinant_once;
+    mutable Tensor<T> inverse_cache;
+    mutable T determinant_cache{};
+
+    // Identité / diagonale / symétrique / dense (seulement pour les types arithmétiques)
+    static MetricKind classify(const Tensor<T>& g)
+    {
+        if constexpr (std::is_arithmetic<T>::value)
+        {
+            if (g.get_shape().size() != 2 || g.get_shape()[0] != g.get_shape()[1])
+                return MetricKind::Dense;
+
+            size_t dim = g.get_shape()[0];
+            bool diagonal = true, identity = true, symmetric = true;
+            for (size_t i = 0; i < dim; ++i)
+            {
+                if (g.data()[i * dim + i] != T(1))
+                    identity = false;
+                for (size_t j = 0; j < dim; ++j)
+                {
+                    if (i != j && g.data()[i * dim + j] != T(0))
+                        diagonal = false;
+                    if (g.data()[i * dim + j] != g.data()[j * dim + i])
+                        symmetric = false;
+                }
+            }
+            if (diagonal)
+                return identity ? MetricKind::Identity : MetricKind::Diagonal;
+            return symmetric ? MetricKind::Symmetric : MetricKind::Dense;
+        }
+        else
+        {
+            return MetricKind::Dense;
+        }
+    }
+
+    // Élimination de Gauss-Jordan avec pivot partiel : inverse et déterminant en une passe
+    void factorize(Tensor<T>* inverse, T* determinant) const
+    {
+        static_assert(std::is_arithmetic<T>::value, "Metric inverse and determinant need an arithmetic type");
+        size_t n = dim();
+        vector<T> a(g.data(), g.data() + n * n);
+        vector<T> inv(n * n, T(0));
+        for (size_t i = 0; i < n; ++i)
+            inv[i * n + i] = T(1);
+
+        T det = T(1);
+        for (size_t c = 0; c < n; ++c)
+        {
+            size_t pivot = c;
+            for (size_t r = c + 1; r < n; ++r)
+                if (std::abs(a[r * n + c]) > std::abs(a[pivot * n + c]))
+                    pivot = r;
+            if (a[pivot * n + c] == T(0))
+            {
+                if (inverse)
+                    throw runtime_error("Singular metric has no inverse");
+                *determinant = T(0);
+                return;
+            }
+            if (pivot != c)
+            {
+                for (size_t k = 0; k < n; ++k)
+                {
+                    std::swap(a[c * n + k], a[pivot * n + k]);
+                    std::swap(inv[c * n + k], inv[pivot * n + k]);
+                }
+                det = -det;
+            }
+
+            T p = a[c * n + c];
+            det *= p;
+            for (size_t k = 0; k < n; ++k)
+            {
+                a[c * n + k] /= p;
+                inv[c * n + k] /= p;
+            }
+            for (size_t r = 0; r < n; ++r)
+            {
+                T f = a[r * n + c];
+                if (r == c || f == T(0))
+                    continue;
+                for (size_t k = 0; k < n; ++k)
+                {
+                    a[r * n + k] -= f * a[c * n + k];
+                    inv[r * n + k] -= f * inv[c * n + k];
+                }
+            }
+        }
+        if (inverse)
+            *inverse = Tensor<T>(vector<size_t>{n, n}, inv);
+        if (determinant)
+            *determinant = det;
+    }
+
+public:
+    explicit Metric(const Tensor<T>& g_)
+        : g(g_), kind(classify(g_))
+    {
+    }
+
+    const Tensor<T>& tensor() const
+    {
+        return g;
+    }
+
+    const T* data() const
+    {
+        return g.data();
+    }
+
+    MetricKind get_kind() const
+    {
+        return kind;
+    }
+
+    size_t dim() const
+    {
+        return g.get_shape().empty() ? 0 : g.get_shape()[0];
+    }
+
+    // g^-1, calculée une seule fois (O(dim) pour une métrique diagonale)
+    const Tensor<T>& inverse() const
+    {
+        std::call_once(inverse_once, [this]
+        {
+            if (g.get_shape().size() != 2 || g.get_shape()[0] != g.get_shape()[1])
+                throw runtime_error("Metric must be a square matrix");
+            size_t n = dim();
+            if (kind == MetricKind::Identity || kind == MetricKind::Diagonal)
+            {
+                inverse_cache = Tensor<T>({n, n}, T(0));
+                for (size_t i = 0; i < n; ++i)
+                {
+                    if (g.data()[i * n + i] == T(0))
+                        throw runtime_error("Singular metric has no inverse");
+                    inverse_cache.data()[i * n + i] = T(1) / g.data()[i * n + i];
+                }
+            }
+            else
+            {
+                factorize(&inverse_cache, nullptr);
+            }
+        });
+        return inverse_cache;
+    }
+
+    // det g, calculé une seule fois
+    T determinant() const
+    {
+        std::call_once(determinant_once, [this]
+        {
+            if (g.get_shape().size() != 2 || g.get_shape()[0] != g.get_shape()[1])
+                throw runtime_error("Metric must be a square matrix");
+            size_t n = dim();
+            if (kind == MetricKind::Identity || kind == MetricKind::Diagonal)
+            {
+                T det = T(1);
+                for (size_t i = 0; i < n; ++i)
+                    det *= g.data()[i * n + i];
+                determinant_cache = det;
+            }
+            else
+            {
+                factorize(nullptr, &determinant_cache);
+            }
+        });
+        return determinant_cache;
+    }
+};
+
+/// Métrique partagée à poser sur autant de tenseurs que voulu : v.set_metric(g);
+template<typename T>
+shared_ptr<const Metric<T>> make_metric(const Tensor<T>& g)
+{
+    TENSOR_PROFILE_OP("make_metric", g.get_shape());
+    return make_shared<const Metric<T>>(g);
+}
+
+/// Tenseur projeté depuis un fichier : rien n'est lu à l'ouverture.
+/// MappedTensor<const T> (Tensor<T>::mmap) en lecture seule,
+/// MappedTensor<T> (Tensor<T>::mmap_copy_on_write) modifiable sans toucher au fichier.
+/// Les copies partagent la projection, libérée avec la dernière d'entre elles.
+/// Opérande des expressions s'il est contigu : Tensor<double> R = M * 2.0 + A;
+template<typename U>
+class MappedTensor
+{
+public:
+    using value_type = typename std::remove_const<U>::type;
+
+private:
+    shared_ptr<tensor_io::MappedFile> file;
+    U* base = nullptr;
+    vector<size_t> shape;
+    vector<size_t> strides;
+    shared_ptr<const Metric<value_type>> metric;
+
+    template<typename... Args>
+    size_t offset_of(Args... args) const
+    {
+#if TENSOR_BOUNDS_CHECK
+        if (sizeof...(Args) != shape.size())
+            throw runtime_error("Index dimension mismatch");
+        size_t c = 0;
+        if (!((static_cast<size_t>(args) < shape[c++]) && ...))
+            throw out_of_range("Index out of bounds");
+#endif
+        size_t idx = 0, d = 0;
+        ((idx += static_cast<size_t>(args) * strides[d++]), ...);
+        return idx;
+    }
+
+public:
+    explicit MappedTensor(const string& path)
+        : file(make_shared<tensor_io::MappedFile>(path, !std::is_const<U>::value))
+    {
+        tensor_io::FileLayout layout = tensor_io::parse_layout<value_type>(file->data(), file->size(), path);
+        base = reinterpret_cast<U*>(file->data() + layout.header.payload_offset);
+        shape = layout.shape;
+        strides = layout.strides;
+
+        const tensor_io::FileHeader& h = layout.header;
+        if (h.metric_offset)
+        {
+            if (h.metric_offset > h.file_size)
+                throw runtime_error("Truncated or corrupt tensor file: " + path);
+            vector<size_t> g_shape;
+            vector<value_type> g_data;
+            tensor_io::parse_metric(file->data() + h.metric_offset, h.file_size - h.metric_offset, g_shape, g_data, path);
+            metric = make_metric(Tensor<value_type>(g_shape, g_data));
+        }
+    }
+
+    const vector<size_t>& get_shape() const
+    {
+        return shape;
+    }
+
+    const vector<size_t>& get_strides() const
+    {
+        return strides;
+    }
+
+    size_t ndim() const
+    {
+        return shape.size();
+    }
+
+    size_t size() const
+    {
+        return std::accumulate(shape.begin(), shape.end(), size_t(1), std::multiplies<size_t>());
+    }
+
+    bool is_contiguous() const
+    {
+        return view().is_contiguous();
+    }
+
+    U* data()
+    {
+        return base;
+    }
+
+    const value_type* data() const
+    {
+        return base;
+    }
+
+    template<typename... Args>
+    U& operator()(Args... args)
+    {
+        return base[offset_of(args...)];
+    }
+
+    template<typename... Args>
+    const value_type& operator()(Args... args) const
+    {
+        return base[offset_of(args...)];
+    }
+
+    TensorView<U> view()
+    {
+        return TensorView<U>(base, shape, strides);
+    }
+
+    TensorView<const value_type> view() const
+    {
+        return TensorView<const value_type>(base, shape, strides);
+    }
+
+    shared_ptr<const Metric<value_type>> get_shared_metric() const
+    {
+        return metric;
+    }
+
+    value_type sum() const
+    {
+        if (is_contiguous())
+            return TensorLeaf<value_type>(*this).sum();
+        return to_tensor().sum();
+    }
+
+    // Copie en mémoire, métrique comprise
+    Tensor<value_type> to_tensor() const
+    {
+        Tensor<value_type> result = view().contiguous();
+        result.set_metric(metric);
+        return result;
+    }
+};
+
+/// Opérateurs élément par élément : renvoient des expressions, évaluées à l'affectation
+template<typename L, typename R>
+using enable_if_tensor_operands = typename std::enable_if<is_tensor_operand<L>::value && is_tensor_operand<R>::value>::type;
+
+template<typename X, typename U>
+using enable_if_tensor_scalar = typename std::enable_if<is_tensor_operand<X>::value && !is_tensor_operand<U>::value>::type;
+
+template<typename L, typename R, typename = enable_if_tensor_operands<L, R>>
+TensorBinaryExpr<expression_type<L>, expression_type<R>, std::plus<typename expression_type<L>::value_type>>
+operator+(const L& lhs, const R& rhs)
+{
+    return {as_expression(lhs), as_expression(rhs)};
+}
+
+template<typename L, typename R, typename = enable_if_tensor_operands<L, R>>
+TensorBinaryExpr<expression_type<L>, expression_type<R>, std::minus<typename expression_type<L>::value_type>>
+operator-(const L& lhs, const R& rhs)
+{
+    return {as_expression(lhs), as_expression(rhs)};
+}
+
+// Produit de Hadamard
+template<typename L, typename R, typename = enable_if_tensor_operands<L, R>>
+TensorBinaryExpr<expression_type<L>, expression_type<R>, std::multiplies<typename expression_type<L>::value_type>>
+operator*(const L& lhs, const R& rhs)
+{
+    return {as_expression(lhs), as_expression(rhs)};
+}
+
+template<typename L, typename R, typename = enable_if_tensor_operands<L, R>>
+TensorBinaryExpr<expression_type<L>, expression_type<R>, std::divides<typename expression_type<L>::value_type>>
+operator/(const L& lhs, const R& rhs)
+{
+    return {as_expression(lhs), as_expression(rhs)};
+}
+
+template<typename X, typename U, typename = enable_if_tensor_scalar<X, U>>
+TensorScalarExpr<expression_type<X>, std::multiplies<typename expression_type<X>::value_type>>
+operator*(const X& tensor, const U& scalar)
+{
+    using T = typename expression_type<X>::value_type;
+    return {as_expression(tensor), static_cast<T>(scalar)};
+}
+
+template<typename U, typename X, typename = enable_if_tensor_scalar<X, U>>
+TensorScalarExpr<expression_type<X>, std::multiplies<typename expression_type<X>::value_type>>
+operator*(const U& scalar, const X& tensor)
+{
+    return tensor * scalar; // réutilise la logique de l'opérateur déjà défini
+}
+
+template<typename X, typename U, typename = enable_if_tensor_scalar<X, U>>
+TensorScalarExpr<expression_type<X>, std::divides<typename expression_type<X>::value_type>>
+operator/(const X& tensor, const U& scalar)
+{
+    using T = typename expression_type<X>::value_type;
+    return {as_expression(tensor), static_cast<T>(scalar)};
+}
+
+namespace tensor_einsum
+{
+
+inline size_t label_id(char c)
+{
+    return static_cast<unsigned char>(c) & 127;
+}
+
+/// Boucle directe sur toutes les lettres : sortie[output] = somme des produits des opérandes.
+/// Utilisée pour les traces et diagonales (lettre répétée dans une opérande) et les sommes
+/// propres à une opérande ; le pas d'une lettre répétée est la somme de ses pas.
+template<typename T>
+Tensor<T> strided(const vector<string>& inputs, const string& output, const vector<TensorView<const T>>& operands,
+                  const size_t* label_dim)
+{
+    size_t n_ops = operands.size();
+    size_t label_count[128] = {0};
+    for (const string& in : inputs)
+        for (char c : in)
+            ++label_count[label_id(c)];
+
+    string summed;
+    for (int c = 0; c < 128; ++c)
+        if (label_count[c] && output.find(static_cast<char>(c)) == string::npos)
+            summed += static_cast<char>(c);
+
+    // Pas de chaque opérande pour chaque lettre (somme des pas si la lettre est répétée : trace, diagonale)
+    string loops = output + summed;
+    size_t n_loops = loops.size();
+    vector<size_t> dims(n_loops);
+    vector<vector<size_t>> op_strides(n_ops, vector<size_t>(n_loops, 0));
+    for (size_t l = 0; l < n_loops; ++l)
+    {
+        dims[l] = label_dim[label_id(loops[l])];
+        for (size_t o = 0; o < n_ops; ++o)
+        {
+            const vector<size_t>& str = operands[o].get_strides();
+            for (size_t d = 0; d < inputs[o].size(); ++d)
+                if (inputs[o][d] == loops[l])
+                    op_strides[o][l] += str[d];
+        }
+    }
+
+    vector<size_t> new_shape(dims.begin(), dims.begin() + output.size());
+    Tensor<T> result(new_shape, T{});
+    size_t total_out = result.size();
+    size_t total_sum = 1;
+    for (size_t l = output.size(); l < n_loops; ++l)
+        total_sum *= dims[l];
+    if (total_out == 0 || total_sum == 0)
+        return result;
+
+    T* out = result.view().get_base();
+    vector<const T*> base_ptr(n_ops);
+    for (size_t o = 0; o < n_ops; ++o)
+        base_ptr[o] = operands[o].get_base() + operands[o].get_offset();
+
+    // Avance d'un cran le compteur des boucles [begin, end) et met à jour les pointeurs
+    auto advance = [&](vector<size_t>& counter, vector<const T*>& ptr, size_t begin, size_t end)
+    {
+        for (size_t l = end; l-- > begin;)
+        {
+            if (++counter[l] < dims[l])
+            {
+                for (size_t o = 0; o < n_ops; ++o)
+                    ptr[o] += op_strides[o][l];
+                return;
+            }
+            for (size_t o = 0; o < n_ops; ++o)
+                ptr[o] -= (dims[l] - 1) * op_strides[o][l];
+            counter[l] = 0;
+        }
+    };
+
+    // La dernière boucle de sommation est déroulée à part (accès à pas constant)
+    size_t first_sum = output.size();
+    size_t inner = (n_loops > first_sum) ? dims.back() : 1;
+    size_t outer_sum = total_sum / inner;
+    vector<size_t> inner_stride(n_ops, 0);
+    if (n_loops > first_sum)
+        for (size_t o = 0; o < n_ops; ++o)
+            inner_stride[o] = op_strides[o].back();
+    size_t last_outer = (n_loops > first_sum) ? n_loops - 1 : n_loops;
+
+    // Sorties réparties sur le pool de threads (types arithmétiques) ;
+    // chaque morceau repart de son propre compteur
+    size_t grain = std::is_arithmetic<T>::value ? std::max<size_t>(1, tensor_kernels::PARALLEL_GRAIN / (total_sum * n_ops)) : total_out;
+    tensor_kernels::parallel_for(0, total_out, grain, [&](size_t r0, size_t r1)
+    {
+        vector<size_t> counter(n_loops, 0);
+        vector<const T*> ptr(base_ptr);
+        for (size_t l = first_sum, r = r0; l-- > 0; r /= dims[l])
+        {
+            counter[l] = r % dims[l];
+            for (size_t o = 0; o < n_ops; ++o)
+                ptr[o] += counter[l] * op_strides[o][l];
+        }
+
+        for (size_t r = r0; r < r1; ++r)
+        {
+            T acc{};
+            for (size_t k = 0; k < outer_sum; ++k)
+            {
+                for (size_t j = 0; j < inner; ++j)
+                {
+                    T prod = ptr[0][j * inner_stride[0]];
+                    for (size_t o = 1; o < n_ops; ++o)
+                        prod = prod * ptr[o][j * inner_stride[o]];
+                    acc = (k == 0 && j == 0) ? prod : acc + prod;
+                }
+                advance(counter, ptr, first_sum, last_outer);
+            }
+            out[r] = acc;
+            advance(counter, ptr, 0, first_sum);
+        }
+    });
+
+    return result;
+}
+
+/// Produit de deux opérandes aux lettres distinctes, ramené à un GEMM (par lots) :
+/// lettres communes gardées (lot), propres à A (lignes), propres à B (colonnes), communes sommées.
+/// Résultat : lettres [lot, A, B] dans labels_out.
+template<typename T>
+Tensor<T> pair(const string& la, const TensorView<const T>& A, const string& lb, const TensorView<const T>& B,
+               const string& kept, const size_t* label_dim, string& labels_out)
+{
+    TENSOR_PROFILE_OP("einsum_pair", A.get_shape());
+    string batch, left, right, summed;
+    for (char c : la)
+    {
+        if (lb.find(c) == string::npos)
+            left += c;
+        else if (kept.find(c) != string::npos)
+            batch += c;
+        else
+            summed += c;
+    }
+    for (char c : lb)
+        if (la.find(c) == string::npos)
+            right += c;
+
+    auto extent = [&](const string& labels)
+    {
+        size_t n = 1;
+        for (char c : labels)
+            n *= label_dim[label_id(c)];
+        return n;
+    };
+    auto order_of = [](const string& labels, const string& wanted)
+    {
+        vector<size_t> order;
+        for (char c : wanted)
+            order.push_back(labels.find(c));
+        return order;
+    };
+
+    size_t nb = extent(batch), M = extent(left), N = extent(right), K = extent(summed);
+    labels_out = batch + left + right;
+    vector<size_t> new_shape;
+    for (char c : labels_out)
+        new_shape.push_back(label_dim[label_id(c)]);
+    Tensor<T> result(new_shape, T{});
+    if (nb == 0 || M == 0 || N == 0 || K == 0)
+        return result;
+
+    // A -> [lot, M, K], B -> [lot, K, N] ; une vue déjà contiguë est utilisée telle quelle
+    TensorView<const T> view_A = A.permute(order_of(la, batch + left + summed));
+    TensorView<const T> view_B = B.permute(order_of(lb, batch + summed + right));
+    Tensor<T> packed_A, packed_B;
+    const T* ptr_A = view_A.get_base() + view_A.get_offset();
+    const T* ptr_B = view_B.get_base() + view_B.get_offset();
+    if (!view_A.is_contiguous())
+    {
+        packed_A = view_A.contiguous();
+        ptr_A = packed_A.data();
+    }
+    if (!view_B.is_contiguous())
+    {
+        packed_B = view_B.contiguous();
+        ptr_B = packed_B.data();
+    }
+
+    TENSOR_PROFILE_FLOPS(2.0 * nb * M * N * K);
+    tensor_kernels::batched_gemm(nb, M, N, K, ptr_A, M * K, ptr_B, K * N, result.view().get_base(), M * N);
+    return result;
+}
+
+} // namespace tensor_einsum
+
+/// Contraction générale à la einsum : einsum("abcd,ac->bd", R, g)
+/// Chaque lettre est un indice ; une lettre absente de la sortie est sommée.
+/// Sans "->", la sortie contient les lettres apparaissant une seule fois, par ordre alphabétique.
+/// Traces, diagonales et sommes propres à une opérande sont d'abord réduites sur place ;
+/// les opérandes sont ensuite contractées deux à deux, la paire la moins coûteuse d'abord,
+/// chaque paire par permutation + GEMM : "ij,jk,kl->il" coûte deux produits matriciels.
+template<typename T, typename... Others>
+Tensor<T> einsum(const string& spec, const Tensor<T>& first, const Others&... others)
+{
+    TENSOR_PROFILE_OP("einsum", first.get_shape());
+    vector<TensorView<const T>> operands = {first.view(), others.view()...};
+    size_t n_ops = operands.size();
+    // Lecture de la spécification
+    string lhs = spec, rhs;
+    bool explicit_output = false;
+    size_t arrow = spec.find("->");
+    if (arrow != string::npos)
+    {
+        lhs = spec.substr(0, arrow);
+        rhs = spec.substr(arrow + 2);
+        explicit_output = true;
+    }
+
+    vector<string> inputs(1);
+    for (char c : lhs)
+    {
+        if (c == ',')
+            inputs.emplace_back();
+        else if (std::isalpha(static_cast<unsigned char>(c)))
+            inputs.back() += c;
+        else if (!std::isspace(static_cast<unsigned char>(c)))
+            throw runtime_error(string("Invalid character in einsum spec: ") + c);
+    }
+    if (inputs.size() != n_ops)
+        throw runtime_error("Number of einsum operands does not match the spec");
+
+    // Dimension et nombre d'occurrences de chaque lettre
+    size_t label_dim[128] = {0};
+    size_t label_count[128] = {0};
+    auto id = [](char c) { return static_cast<unsigned char>(c) & 127; };
+    for (size_t o = 0; o < n_ops; ++o)
+    {
+        const vector<size_t>& shp = operands[o].get_shape();
+        if (inputs[o].size() != shp.size())
+            throw runtime_error("Einsum subscripts do not match operand rank");
+        for (size_t d = 0; d < shp.size(); ++d)
+        {
+            char c = inputs[o][d];
+            if (label_count[id(c)] && label_dim[id(c)] != shp[d])
+                throw runtime_error(string("Mismatched dimensions for einsum index ") + c);
+            label_dim[id(c)] = shp[d];
+            ++label_count[id(c)];
+        }
+    }
+
+    string output;
+    if (explicit_output)
+    {
+        for (char c : rhs)
+        {
+            if (std::isspace(static_cast<unsigned char>(c)))
+                continue;
+            if (!std::isalpha(static_cast<unsigned char>(c)) || !label_count[id(c)])
+                throw runtime_error(string("Unknown einsum output index: ") + c);
+            if (output.find(c) != string::npos)
+                throw runtime_error(string("Repeated einsum output index: ") + c);
+            output += c;
+        }
+    }
+    else
+    {
+        for (int c = 0; c < 128; ++c)
+            if (label_count[c] == 1)
+                output += static_cast<char>(c);
+    }
+
+    using tensor_einsum::label_id;
+
+    // Lettres encore nécessaires hors de l'opérande skip : sortie et autres opérandes
+    auto kept_without = [&](const vector<string>& labels, size_t skip)
+    {
+        string kept = output;
+        for (size_t o = 0; o < labels.size(); ++o)
+            if (o != skip)
+                kept += labels[o];
+        return kept;
+    };
+
+    // Opérandes de travail ; les intermédiaires sont gardés en vie dans owned
+    std::deque<Tensor<T>> owned;
+    vector<string> labels = inputs;
+    vector<TensorView<const T>> views = operands;
+
+    // 1. Réduction de chaque opérande à des lettres distinctes, toutes encore utiles
+    for (size_t o = 0; o < labels.size(); ++o)
+    {
+        string kept = kept_without(labels, o), reduced;
+        for (char c : labels[o])
+            if (kept.find(c) != string::npos && reduced.find(c) == string::npos)
+                reduced += c;
+        if (reduced == labels[o] && n_ops > 1)
+            continue;
+        if (n_ops == 1)
+            reduced = output;
+        owned.push_back(tensor_einsum::strided<T>({labels[o]}, reduced, {views[o]}, label_dim));
+        labels[o] = reduced;
+        views[o] = std::as_const(owned.back()).view();
+    }
+
+    // 2. Paires : coût = produit des dimensions de toutes leurs lettres
+    while (labels.size() > 1)
+    {
+        size_t best_i = 0, best_j = 1;
+        double best_cost = -1;
+        for (size_t i = 0; i < labels.size(); ++i)
+            for (size_t j = i + 1; j < labels.size(); ++j)
+            {
+                double cost = 1;
+                string both = labels[i] + labels[j];
+                for (size_t q = 0; q < both.size(); ++q)
+                    if (both.find(both[q]) == q)
+                        cost *= double(label_dim[label_id(both[q])]);
+                if (best_cost < 0 || cost < best_cost)
+                {
+                    best_cost = cost;
+                    best_i = i;
+                    best_j = j;
+                }
+            }
+
+        string kept = output;
+        for (size_t o = 0; o < labels.size(); ++o)
+            if (o != best_i && o != best_j)
+                kept += labels[o];
+        string joined;
+        owned.push_back(tensor_einsum::pair<T>(labels[best_i], views[best_i], labels[best_j], views[best_j], kept, label_dim, joined));
+
+        labels.erase(labels.begin() + best_j);
+        views.erase(views.begin() + best_j);
+        labels[best_i] = joined;
+        views[best_i] = std::as_const(owned.back()).view();
+    }
+
+    // 3. Lettres restantes dans l'ordre de la sortie
+    if (labels[0] == output && !owned.empty())
+        return std::move(owned.back());
+    vector<size_t> order;
+    for (char c : output)
+        order.push_back(labels[0].find(c));
+    return views[0].permute(order).contiguous();
+}
+
+#endif // TENSEURS_H_INCLUDED
@@ -0,0 +1,185 @@
+///  -------------------------------------------------
+///  Allocators used by Tenseurs.h
+///  StandAlone, header only
+///  Coded by JP CHAMPEAUX
+///  contact : JPC@irsamc.upse-tlse.fr
+///  Free of use for Academic purpose only !
+///  (please, just mention author in your works if used or if your own code is inspired from it)
+///  --------------------------------------------------
+
+
+#ifndef TENSEURS_ALLOC_H_INCLUDED
+#define TENSEURS_ALLOC_H_INCLUDED
+
+#include <cstddef>
+#include <new>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+
+#include "Tenseurs_profile.h"
+
+/// Allocateur aligné (64 octets par défaut : une ligne de cache, un registre AVX-512).
+/// Allocateur par défaut des Tensor de types arithmétiques.
+template<typename T, size_t Align = 64>
+struct AlignedAllocator
+{
+    static_assert(Align >= alignof(T) && (Align & (Align - 1)) == 0, "Alignment must be a power of two");
+
+    using value_type = T;
+
+    template<typename U>
+    struct rebind
+    {
+        using other = AlignedAllocator<U, Align>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Align>&) noexcept
+    {
+    }
+
+    T* allocate(size_t n)
+    {
+        TENSOR_PROFILE_ALLOC(n * sizeof(T));
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Align)));
+    }
+
+    void deallocate(T* p, size_t) noexcept
+    {
+        ::operator delete(p, std::align_val_t(Align));
+    }
+
+    template<typename U>
+    bool operator==(const AlignedAllocator<U, Align>&) const noexcept
+    {
+        return true;
+    }
+
+    template<typename U>
+    bool operator!=(const AlignedAllocator<U, Align>&) const noexcept
+    {
+        return false;
+    }
+};
+
+/// Arène par thread pour les tenseurs temporaires.
+/// Allocation par incrément d'un pointeur dans de grands blocs, libération sans effet ;
+/// reset() rend toute la mémoire d'un coup (typiquement à la fin de chaque itération).
+/// Un tenseur alloué dans l'arène ne doit plus être utilisé après reset().
+class TensorArena
+{
+    struct Block
+    {
+        char* data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    size_t current = 0;  // bloc en cours
+    size_t used = 0;     // octets utilisés dans le bloc en cours
+
+    static constexpr size_t ALIGN = 64;
+    static constexpr size_t MIN_BLOCK = size_t(1) << 20;
+
+public:
+    TensorArena() = default;
+    TensorArena(const TensorArena&) = delete;
+    TensorArena& operator=(const TensorArena&) = delete;
+
+    ~TensorArena()
+    {
+        for (Block& b : blocks)
+            ::operator delete(b.data, std::align_val_t(ALIGN));
+    }
+
+    void* allocate(size_t bytes)
+    {
+        bytes = (bytes + ALIGN - 1) / ALIGN * ALIGN;
+        while (current < blocks.size())
+        {
+            if (used + bytes <= blocks[current].size)
+            {
+                void* p = blocks[current].data + used;
+                used += bytes;
+                return p;
+            }
+            ++current;
+            used = 0;
+        }
+
+        size_t size = std::max(bytes, blocks.empty() ? MIN_BLOCK : 2 * blocks.back().size);
+        blocks.push_back({static_cast<char*>(::operator new(size, std::align_val_t(ALIGN))), size});
+        current = blocks.size() - 1;
+        used = bytes;
+        return blocks.back().data;
+    }
+
+    // Toute la mémoire redevient disponible ; les blocs sont conservés pour l'itération suivante
+    void reset() noexcept
+    {
+        current = 0;
+        used = 0;
+    }
+
+    size_t capacity() const noexcept
+    {
+        size_t total = 0;
+        for (const Block& b : blocks)
+            total += b.size;
+        return total;
+    }
+
+    // Arène du thread appelant
+    static TensorArena& local()
+    {
+        static thread_local TensorArena arena;
+        return arena;
+    }
+};
+
+/// Allocateur sur l'arène du thread appelant : Tensor<double, ArenaAllocator<double>>.
+/// deallocate ne fait rien, la mémoire est rendue par TensorArena::local().reset().
+template<typename T>
+struct ArenaAllocator
+{
+    using value_type = T;
+
+    ArenaAllocator() noexcept = default;
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>&) noexcept
+    {
+    }
+
+    T* allocate(size_t n)
+    {
+        TENSOR_PROFILE_ALLOC(n * sizeof(T));
+        return static_cast<T*>(TensorArena::local().allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T*, size_t) noexcept
+    {
+    }
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>&) const noexcept
+    {
+        return true;
+    }
+
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U>&) const noexcept
+    {
+        return false;
+    }
+};
+
+/// Allocateur par défaut d'un Tensor<T> : aligné pour les types arithmétiques, std::allocator sinon
+template<typename T>
+using default_tensor_allocator = typename std::conditional<std::is_arithmetic<T>::value, AlignedAllocator<T>, std::allocator<T>>::type;
+
+#endif // TENSEURS_ALLOC_H_INCLUDED
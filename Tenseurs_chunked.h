@@ -0,0 +1,450 @@
+///  -------------------------------------------------
+///  ChunkedTensor : tenseur sur disque, traité par tuiles
+///  StandAlone class, header only
+///  Coded by JP CHAMPEAUX
+///  contact : JPC@irsamc.upse-tlse.fr
+///  Free of use for Academic purpose only !
+///  (please, just mention author in your works if used or if your own code is inspired from it)
+///  CLASS ChunkedTensor
+///  --------------------------------------------------
+
+
+#ifndef TENSEURS_CHUNKED_H_INCLUDED
+#define TENSEURS_CHUNKED_H_INCLUDED
+
+#include <fstream>
+#include <functional>
+#include <string>
+#include <utility>
+
+#ifndef TENSOR_NO_THREADS
+#include <future>
+#endif
+
+#include "Tenseurs.h"
+
+/// Tenseur plus grand que la mémoire, rangé dans un fichier binaire (Tensor<T>::save, Tenseurs_io.h).
+/// Les calculs lisent le fichier par tuiles de lignes consécutives (premier axe), chacune
+/// étant un Tensor<T> ordinaire : expressions, SIMD et threads s'appliquent à l'intérieur.
+/// La tuile suivante est lue en arrière-plan pendant le calcul sur la tuile courante.
+/// Mémoire bornée par le budget : tuiles courante et suivante de chaque entrée, plus le résultat.
+template<typename T>
+class ChunkedTensor
+{
+private:
+    string path;
+    tensor_io::FileHeader header;
+    vector<size_t> shape;
+    size_t row_size = 1;    // éléments par ligne (produit des axes après le premier)
+    size_t tile_rows = 1;   // lignes par tuile
+    size_t memory_budget = 0;
+    shared_ptr<const Metric<T>> metric;
+
+    vector<size_t> tile_shape(size_t rows) const
+    {
+        vector<size_t> s = shape;
+        s[0] = rows;
+        return s;
+    }
+
+    // Lignes [r0, r0 + rows) ; la tuile n'est réallouée que si sa forme change
+    void read_tile(std::ifstream& in, size_t r0, size_t rows, Tensor<T>& tile) const
+    {
+        if (tile.get_shape() != tile_shape(rows))
+            tile = Tensor<T>(tile_shape(rows));
+        tensor_io::read_elements(path, in, header, uint64_t(r0) * row_size, uint64_t(rows) * row_size, tile.data());
+    }
+
+    /// f(tuiles, r0) sur les tuiles de mêmes lignes de toutes les sources (même premier axe).
+    /// Double tampon : la lecture des tuiles suivantes chevauche f sur les tuiles courantes.
+    template<typename F>
+    static void stream_tiles(const vector<const ChunkedTensor*>& sources, size_t rows_per_tile, F&& f)
+    {
+        size_t n_rows = sources[0]->shape[0];
+        size_t n = sources.size();
+        vector<std::ifstream> in(n);
+        for (size_t k = 0; k < n; ++k)
+        {
+            in[k].open(sources[k]->path, std::ios::binary);
+            if (!in[k])
+                throw runtime_error("Cannot open tensor file: " + sources[k]->path);
+        }
+
+        vector<Tensor<T>> current(n), next(n);
+        auto load = [&](size_t r0, vector<Tensor<T>>& tiles)
+        {
+            size_t rows = std::min(rows_per_tile, n_rows - r0);
+            for (size_t k = 0; k < n; ++k)
+                sources[k]->read_tile(in[k], r0, rows, tiles[k]);
+        };
+
+        if (n_rows == 0)
+            return;
+        load(0, current);
+        for (size_t r0 = 0; r0 < n_rows; r0 += rows_per_tile)
+        {
+            size_t r_next = r0 + rows_per_tile;
+#ifndef TENSOR_NO_THREADS
+            std::future<void> pending;
+            if (r_next < n_rows)
+                pending = std::async(std::launch::async, load, r_next, std::ref(next));
+            try
+            {
+                f(static_cast<const vector<Tensor<T>>&>(current), r0);
+            }
+            catch (...)
+            {
+                if (pending.valid())
+                    pending.wait();
+                throw;
+            }
+            if (pending.valid())
+                pending.get();
+#else
+            f(static_cast<const vector<Tensor<T>>&>(current), r0);
+            if (r_next < n_rows)
+                load(r_next, next);
+#endif
+            std::swap(current, next);
+        }
+    }
+
+    // Écrit les tuiles résultat à la suite ; la forme du fichier est fixée par la première
+    struct TileWriter
+    {
+        string path;
+        size_t n_rows;
+        std::unique_ptr<tensor_io::FileWriter<T>> writer;
+
+        void write(const Tensor<T>& tile, size_t rows)
+        {
+            if (tile.ndim() == 0 || tile.get_shape()[0] != rows)
+                throw runtime_error("Chunked result tile must keep the leading axis");
+            if (!writer)
+            {
+                vector<size_t> out_shape = tile.get_shape();
+                out_shape[0] = n_rows;
+                writer.reset(new tensor_io::FileWriter<T>(path, out_shape, row_major_strides(out_shape)));
+            }
+            writer->append(tile.data(), tile.size());
+        }
+
+        void finish(const vector<size_t>& default_shape)
+        {
+            if (!writer)
+                writer.reset(new tensor_io::FileWriter<T>(path, default_shape, row_major_strides(default_shape)));
+            writer->finish();
+        }
+    };
+
+    static vector<size_t> row_major_strides(const vector<size_t>& s)
+    {
+        vector<size_t> strides(s.size());
+        size_t stride = 1;
+        for (size_t i = s.size(); i-- > 0;)
+        {
+            strides[i] = stride;
+            stride *= s[i];
+        }
+        return strides;
+    }
+
+    // Même contrôle que Tensor::contract_with
+    void check_metric(size_t dim) const
+    {
+        const vector<size_t>& g = metric->tensor().get_shape();
+        if (g.size() != 2 || g[0] != dim || g[1] != dim)
+            throw runtime_error("Metric must be a square matrix matching contraction dimension");
+    }
+
+    // Poids g_rr d'une métrique diagonale sur le premier axe (vide : identité ou pas de métrique)
+    vector<T> leading_weights() const
+    {
+        vector<T> w;
+        if (!metric || metric->get_kind() == MetricKind::Identity)
+            return w;
+        check_metric(shape[0]);
+        if (metric->get_kind() != MetricKind::Diagonal)
+            throw runtime_error("Chunked contract_leading supports only identity or diagonal metrics on the leading axis");
+        w.resize(shape[0]);
+        for (size_t r = 0; r < shape[0]; ++r)
+            w[r] = metric->data()[r * shape[0] + r];
+        return w;
+    }
+
+    // Copie de la tuile, ligne r multipliée par w[r]
+    Tensor<T> scale_rows(const Tensor<T>& tile, const T* w) const
+    {
+        Tensor<T> scaled(tile.get_shape());
+        size_t rows = tile.get_shape()[0];
+        const T* src = tile.data();
+        T* dst = scaled.data();
+        for (size_t r = 0; r < rows; ++r)
+            for (size_t k = 0; k < row_size; ++k)
+                dst[r * row_size + k] = w[r] * src[r * row_size + k];
+        return scaled;
+    }
+
+    size_t rows_for_budget(size_t budget, size_t n_buffers) const
+    {
+        size_t row_bytes = std::max<size_t>(row_size * sizeof(T), 1);
+        return std::max<size_t>(budget / (n_buffers * row_bytes), 1);
+    }
+
+public:
+    static constexpr size_t DEFAULT_BUDGET = size_t(256) << 20;
+
+    /// Ouvre un fichier écrit par Tensor<T>::save ou ChunkedTensor ; rien n'est lu à part l'en-tête
+    explicit ChunkedTensor(const string& path_, size_t memory_budget_ = DEFAULT_BUDGET)
+        : path(path_)
+    {
+        std::ifstream in;
+        tensor_io::FileLayout layout = tensor_io::open_file<T>(path, in);
+        header = layout.header;
+        shape = layout.shape;
+        if (shape.empty())
+            throw runtime_error("Chunked tensors need at least one axis");
+        if (layout.strides != row_major_strides(shape))
+            throw runtime_error("Chunked tensors need a row-major file: " + path);
+
+        for (size_t d = 1; d < shape.size(); ++d)
+            row_size *= shape[d];
+
+        vector<size_t> g_shape;
+        vector<T> g_data;
+        tensor_io::read_metric(path, in, header, g_shape, g_data);
+        if (!g_shape.empty())
+            metric = make_metric(Tensor<T>(g_shape, g_data));
+
+        set_memory_budget(memory_budget_);
+    }
+
+    /// Nouveau fichier rempli de init, écrit par tuiles
+    static ChunkedTensor create(const string& path, const vector<size_t>& shape, T init = T(), size_t memory_budget = DEFAULT_BUDGET)
+    {
+        if (shape.empty())
+            throw runtime_error("Chunked tensors need at least one axis");
+        size_t row = std::accumulate(shape.begin() + 1, shape.end(), size_t(1), std::multiplies<size_t>());
+        size_t rows = std::max<size_t>(memory_budget / std::max<size_t>(row * sizeof(T), 1), 1);
+        vector<T> block(std::min(rows, shape[0]) * row, init);
+
+        tensor_io::FileWriter<T> writer(path, shape, row_major_strides(shape));
+        for (size_t r0 = 0; r0 < shape[0]; r0 += rows)
+            writer.append(block.data(), std::min(rows, shape[0] - r0) * row);
+        writer.finish();
+        return ChunkedTensor(path, memory_budget);
+    }
+
+    static ChunkedTensor from_tensor(const string& path, const Tensor<T>& t, size_t memory_budget = DEFAULT_BUDGET)
+    {
+        t.save(path);
+        return ChunkedTensor(path, memory_budget);
+    }
+
+    /// Budget mémoire (octets) d'une opération : fixe le nombre de lignes par tuile
+    void set_memory_budget(size_t bytes)
+    {
+        memory_budget = bytes;
+        // tuile courante + tuile en lecture + tuile résultat (et sa marge)
+        tile_rows = rows_for_budget(bytes, 4);
+    }
+
+    size_t rows_per_tile() const
+    {
+        return tile_rows;
+    }
+
+    const string& get_path() const
+    {
+        return path;
+    }
+
+    const vector<size_t>& get_shape() const
+    {
+        return shape;
+    }
+
+    size_t ndim() const
+    {
+        return shape.size();
+    }
+
+    size_t size() const
+    {
+        return header.count;
+    }
+
+    shared_ptr<const Metric<T>> get_shared_metric() const
+    {
+        return metric;
+    }
+
+    /// Lignes [r0, r1) en mémoire
+    Tensor<T> rows(size_t r0, size_t r1) const
+    {
+        if (r0 > r1 || r1 > shape[0])
+            throw out_of_range("Invalid row range");
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+            throw runtime_error("Cannot open tensor file: " + path);
+        Tensor<T> tile;
+        read_tile(in, r0, r1 - r0, tile);
+        return tile;
+    }
+
+    /// Tout le tenseur en mémoire, métrique comprise
+    Tensor<T> to_tensor() const
+    {
+        Tensor<T> result = rows(0, shape[0]);
+        result.set_metric(metric);
+        return result;
+    }
+
+    /// f(tuile, première ligne) sur chaque tuile, dans l'ordre
+    template<typename F>
+    void for_each_tile(F f) const
+    {
+        stream_tiles({this}, tile_rows, [&](const vector<Tensor<T>>& tiles, size_t r0)
+        {
+            f(tiles[0], r0);
+        });
+    }
+
+    /// Élément par élément (ou toute opération qui garde le premier axe) :
+    /// out = f(tuile) pour chaque tuile, écrit dans out_path.
+    /// C.map("C.tns", [](const Tensor<double>& t) { return Tensor<double>(t * 2.0 + 1.0); });
+    template<typename F>
+    ChunkedTensor map(const string& out_path, F f) const
+    {
+        if (out_path == path)
+            throw runtime_error("Chunked result must go to another file");
+        TileWriter out{out_path, shape[0], nullptr};
+        stream_tiles({this}, tile_rows, [&](const vector<Tensor<T>>& tiles, size_t)
+        {
+            Tensor<T> result = f(tiles[0]);
+            out.write(result, tiles[0].get_shape()[0]);
+        });
+        out.finish(shape);
+        return ChunkedTensor(out_path, memory_budget);
+    }
+
+    /// out = f(tuile de *this, tuile de other) ; même premier axe
+    template<typename F>
+    ChunkedTensor zip(const ChunkedTensor& other, const string& out_path, F f) const
+    {
+        if (other.shape[0] != shape[0])
+            throw runtime_error("Chunked tensors must have the same leading dimension");
+        if (out_path == path || out_path == other.path)
+            throw runtime_error("Chunked result must go to another file");
+        TileWriter out{out_path, shape[0], nullptr};
+        size_t rows = std::min(rows_for_budget(memory_budget, 6), other.rows_for_budget(memory_budget, 6));
+        stream_tiles({this, &other}, rows, [&](const vector<Tensor<T>>& tiles, size_t)
+        {
+            Tensor<T> result = f(tiles[0], tiles[1]);
+            out.write(result, tiles[0].get_shape()[0]);
+        });
+        out.finish(shape);
+        return ChunkedTensor(out_path, memory_budget);
+    }
+
+    /// Réduction : combine(acc, map(tuile)) dans l'ordre des tuiles
+    template<typename R, typename Map, typename Combine>
+    R reduce(R init, Map map_tile, Combine combine) const
+    {
+        R acc = init;
+        stream_tiles({this}, tile_rows, [&](const vector<Tensor<T>>& tiles, size_t)
+        {
+            acc = combine(acc, map_tile(tiles[0]));
+        });
+        return acc;
+    }
+
+    T sum() const
+    {
+        return reduce(T(0), [](const Tensor<T>& tile) { return tile.sum(); }, std::plus<T>());
+    }
+
+    /// Contraction avec un tenseur en mémoire sur un axe autre que le premier (axis_A >= 1).
+    /// Même convention que Tensor::contract_with, métrique du fichier comprise ; le premier axe
+    /// reste en tête du résultat, écrit tuile par tuile dans out_path.
+    ChunkedTensor contract_with(const Tensor<T>& B, size_t axis_A, size_t axis_B, const string& out_path) const
+    {
+        if (axis_A == 0 || axis_A >= shape.size())
+            throw runtime_error("Chunked contraction axis must be >= 1 (use contract_leading for axis 0)");
+        if (axis_B >= B.ndim() || B.get_shape()[axis_B] != shape[axis_A])
+            throw runtime_error("Mismatched dimensions for contraction");
+
+        // Les tuiles lues n'ont pas de métrique : A g B = A (g B), g B calculé une fois en mémoire
+        bool weighted = metric && metric->get_kind() != MetricKind::Identity;
+        Tensor<T> gB;
+        if (weighted)
+        {
+            check_metric(shape[axis_A]);
+            gB = metric->tensor().contract_with(B, 1, axis_B);
+        }
+        const Tensor<T>& rhs = weighted ? gB : B;
+        size_t axis = weighted ? 0 : axis_B;
+        return map(out_path, [&](const Tensor<T>& tile)
+        {
+            return tile.contract_with(rhs, axis_A, axis);
+        });
+    }
+
+    /// Contraction sur le premier axe de deux tenseurs sur disque (A^T B par blocs de lignes).
+    /// Le résultat (axes restants de *this puis de B) est accumulé en mémoire.
+    /// Avec une métrique sur le premier axe, seules l'identité et les métriques diagonales
+    /// se découpent par tuiles (une métrique pleine couple les lignes de tuiles différentes).
+    Tensor<T> contract_leading(const ChunkedTensor& B) const
+    {
+        if (B.shape[0] != shape[0])
+            throw runtime_error("Dimension mismatch for contraction");
+        vector<T> weights = leading_weights();
+        Tensor<T> acc;
+        bool first = true;
+        size_t rows = std::min(rows_for_budget(memory_budget, 4), B.rows_for_budget(memory_budget, 4));
+        stream_tiles({this, &B}, rows, [&](const vector<Tensor<T>>& tiles, size_t r0)
+        {
+            Tensor<T> part = weights.empty() ? tiles[0].contract_with(tiles[1], 0, 0)
+                                             : scale_rows(tiles[0], weights.data() + r0).contract_with(tiles[1], 0, 0);
+            if (first)
+                acc = std::move(part);
+            else
+                acc += part;
+            first = false;
+        });
+        return acc;
+    }
+
+    /// Contraction du premier axe avec l'axe axis_B d'un tenseur en mémoire
+    /// B est en mémoire : une métrique quelconque s'applique à B (g B) avant le découpage
+    Tensor<T> contract_leading(const Tensor<T>& B, size_t axis_B) const
+    {
+        if (axis_B >= B.ndim() || B.get_shape()[axis_B] != shape[0])
+            throw runtime_error("Dimension mismatch for contraction");
+        bool weighted = metric && metric->get_kind() != MetricKind::Identity;
+        Tensor<T> gB;
+        if (weighted)
+        {
+            check_metric(shape[0]);
+            gB = metric->tensor().contract_with(B, 1, axis_B);
+        }
+        const Tensor<T>& rhs = weighted ? gB : B;
+        size_t axis = weighted ? 0 : axis_B;
+        Tensor<T> acc;
+        bool first = true;
+        stream_tiles({this}, tile_rows, [&](const vector<Tensor<T>>& tiles, size_t r0)
+        {
+            size_t r1 = r0 + tiles[0].get_shape()[0];
+            Tensor<T> B_rows = rhs.slice({std::make_tuple(axis, r0, r1)});
+            Tensor<T> part = tiles[0].contract_with(B_rows, 0, axis);
+            if (first)
+                acc = std::move(part);
+            else
+                acc += part;
+            first = false;
+        });
+        return acc;
+    }
+};
+
+#endif // TENSEURS_CHUNKED_H_INCLUDED
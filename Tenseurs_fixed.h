@@ -0,0 +1,281 @@
+///  -------------------------------------------------
+///  FixedTensor : tenseur de forme connue à la compilation
+///  StandAlone class, header only
+///  Coded by JP CHAMPEAUX
+///  contact : JPC@irsamc.upse-tlse.fr
+///  Free of use for Academic purpose only !
+///  (please, just mention author in your works if used or if your own code is inspired from it)
+///  CLASS FixedTensor
+///  --------------------------------------------------
+
+
+#ifndef TENSEURS_FIXED_H_INCLUDED
+#define TENSEURS_FIXED_H_INCLUDED
+
+#include <array>
+#include <initializer_list>
+#include <utility>
+
+#include "Tenseurs.h"
+
+/// Tenseur de forme fixe (FixedTensor<double, 4, 4> pour une métrique, FixedTensor<double, 4> pour un 4-vecteur).
+/// Stockage en ligne (std::array, pas d'allocation), shape et strides constexpr,
+/// calcul d'indice entièrement déroulé par le compilateur.
+/// Se convertit implicitement en Tensor<T> ; un Tensor<T> se convertit explicitement (forme vérifiée).
+template<typename T, size_t... Dims>
+class FixedTensor
+{
+public:
+    static constexpr size_t rank = sizeof...(Dims);
+    static constexpr size_t total = (Dims * ... * size_t(1));
+    static constexpr std::array<size_t, rank> shape = {Dims...};
+
+private:
+    static constexpr std::array<size_t, rank> make_strides()
+    {
+        std::array<size_t, rank> s{};
+        size_t stride = 1;
+        for (size_t i = rank; i-- > 0;)
+        {
+            s[i] = stride;
+            stride *= shape[i];
+        }
+        return s;
+    }
+
+    template<size_t... I, typename... Args>
+    static constexpr size_t flatten_index(std::index_sequence<I...>, Args... args)
+    {
+        return ((static_cast<size_t>(args) * strides[I]) + ... + size_t(0));
+    }
+
+public:
+    static constexpr std::array<size_t, rank> strides = make_strides();
+
+    std::array<T, total> data{};
+
+    constexpr FixedTensor() = default;
+
+    constexpr explicit FixedTensor(T init_val)
+    {
+        fill(init_val);
+    }
+
+    // Valeurs en row-major : FixedTensor<double, 2, 2> g({1, 0, 0, -1});
+    constexpr FixedTensor(std::initializer_list<T> values)
+    {
+        if (values.size() != total)
+            throw runtime_error("Data size does not match shape");
+        size_t i = 0;
+        for (const T& v : values)
+            data[i++] = v;
+    }
+
+    explicit FixedTensor(const Tensor<T>& other)
+    {
+        const vector<size_t>& other_shape = other.get_shape();
+        if (other_shape.size() != rank || !std::equal(other_shape.begin(), other_shape.end(), shape.begin()))
+            throw runtime_error("Shape mismatch in conversion to FixedTensor");
+        std::copy(other.get_data().begin(), other.get_data().end(), data.begin());
+    }
+
+    operator Tensor<T>() const
+    {
+        return Tensor<T>(vector<size_t>(shape.begin(), shape.end()), vector<T>(data.begin(), data.end()));
+    }
+
+    // Accès sans allocation ni vérification (indices en nombre = rank, vérifié à la compilation)
+    template<typename... Args>
+    constexpr T& operator()(Args... args)
+    {
+        static_assert(sizeof...(Args) == rank, "Index dimension mismatch");
+        return data[flatten_index(std::make_index_sequence<rank>(), args...)];
+    }
+
+    template<typename... Args>
+    constexpr const T& operator()(Args... args) const
+    {
+        static_assert(sizeof...(Args) == rank, "Index dimension mismatch");
+        return data[flatten_index(std::make_index_sequence<rank>(), args...)];
+    }
+
+    static constexpr size_t ndim()
+    {
+        return rank;
+    }
+
+    static constexpr size_t size()
+    {
+        return total;
+    }
+
+    TensorView<T> view()
+    {
+        return TensorView<T>(data.data(), vector<size_t>(shape.begin(), shape.end()), vector<size_t>(strides.begin(), strides.end()));
+    }
+
+    TensorView<const T> view() const
+    {
+        return TensorView<const T>(data.data(), vector<size_t>(shape.begin(), shape.end()), vector<size_t>(strides.begin(), strides.end()));
+    }
+
+    constexpr void fill(T val)
+    {
+        for (size_t i = 0; i < total; ++i)
+            data[i] = val;
+    }
+
+    constexpr T sum() const
+    {
+        T acc = T();
+        for (size_t i = 0; i < total; ++i)
+            acc = acc + data[i];
+        return acc;
+    }
+
+    constexpr T pseudo_norm() const
+    {
+        T acc = T(0);
+        for (size_t i = 0; i < total; ++i)
+            acc = acc + data[i] * data[i];
+        return acc;
+    }
+
+    friend constexpr FixedTensor operator+(const FixedTensor& a, const FixedTensor& b)
+    {
+        FixedTensor r;
+        for (size_t i = 0; i < total; ++i)
+            r.data[i] = a.data[i] + b.data[i];
+        return r;
+    }
+
+    friend constexpr FixedTensor operator-(const FixedTensor& a, const FixedTensor& b)
+    {
+        FixedTensor r;
+        for (size_t i = 0; i < total; ++i)
+            r.data[i] = a.data[i] - b.data[i];
+        return r;
+    }
+
+    // Produit de Hadamard
+    friend constexpr FixedTensor operator*(const FixedTensor& a, const FixedTensor& b)
+    {
+        FixedTensor r;
+        for (size_t i = 0; i < total; ++i)
+            r.data[i] = a.data[i] * b.data[i];
+        return r;
+    }
+
+    friend constexpr FixedTensor operator*(const FixedTensor& a, const T& scalar)
+    {
+        FixedTensor r;
+        for (size_t i = 0; i < total; ++i)
+            r.data[i] = a.data[i] * scalar;
+        return r;
+    }
+
+    friend constexpr FixedTensor operator*(const T& scalar, const FixedTensor& a)
+    {
+        return a * scalar;
+    }
+
+    constexpr FixedTensor& operator+=(const FixedTensor& other)
+    {
+        for (size_t i = 0; i < total; ++i)
+            data[i] = data[i] + other.data[i];
+        return *this;
+    }
+
+    constexpr FixedTensor& operator-=(const FixedTensor& other)
+    {
+        for (size_t i = 0; i < total; ++i)
+            data[i] = data[i] - other.data[i];
+        return *this;
+    }
+
+    constexpr FixedTensor& operator*=(const T& scalar)
+    {
+        for (size_t i = 0; i < total; ++i)
+            data[i] = data[i] * scalar;
+        return *this;
+    }
+
+    friend ostream& operator<<(ostream& os, const FixedTensor& t)
+    {
+        return os << Tensor<T>(t);
+    }
+
+    void print(bool detailed = false) const
+    {
+        Tensor<T>(*this).print(detailed);
+    }
+};
+
+/// Contractions à taille fixe (dernier axe de A avec premier axe de B), boucles déroulables.
+/// Même sens que Tensor::contract_with (Tensor::contract est une trace sur deux axes d'un même tenseur).
+template<typename T, size_t N>
+constexpr T contract_with(const FixedTensor<T, N>& a, const FixedTensor<T, N>& b)
+{
+    static_assert(N > 0, "Contraction over an empty axis");
+    T acc = a.data[0] * b.data[0];
+    for (size_t k = 1; k < N; ++k)
+        acc = acc + a.data[k] * b.data[k];
+    return acc;
+}
+
+template<typename T, size_t M, size_t N>
+constexpr FixedTensor<T, M> contract_with(const FixedTensor<T, M, N>& a, const FixedTensor<T, N>& v)
+{
+    static_assert(N > 0, "Contraction over an empty axis");
+    FixedTensor<T, M> r;
+    for (size_t i = 0; i < M; ++i)
+    {
+        T acc = a.data[i * N] * v.data[0];
+        for (size_t k = 1; k < N; ++k)
+            acc = acc + a.data[i * N + k] * v.data[k];
+        r.data[i] = acc;
+    }
+    return r;
+}
+
+template<typename T, size_t M, size_t N>
+constexpr FixedTensor<T, N> contract_with(const FixedTensor<T, M>& v, const FixedTensor<T, M, N>& a)
+{
+    static_assert(M > 0, "Contraction over an empty axis");
+    FixedTensor<T, N> r;
+    for (size_t j = 0; j < N; ++j)
+    {
+        T acc = v.data[0] * a.data[j];
+        for (size_t k = 1; k < M; ++k)
+            acc = acc + v.data[k] * a.data[k * N + j];
+        r.data[j] = acc;
+    }
+    return r;
+}
+
+template<typename T, size_t M, size_t K, size_t N>
+constexpr FixedTensor<T, M, N> contract_with(const FixedTensor<T, M, K>& a, const FixedTensor<T, K, N>& b)
+{
+    static_assert(K > 0, "Contraction over an empty axis");
+    FixedTensor<T, M, N> r;
+    for (size_t i = 0; i < M; ++i)
+    {
+        for (size_t j = 0; j < N; ++j)
+        {
+            T acc = a.data[i * K] * b.data[j];
+            for (size_t k = 1; k < K; ++k)
+                acc = acc + a.data[i * K + k] * b.data[k * N + j];
+            r.data[i * N + j] = acc;
+        }
+    }
+    return r;
+}
+
+/// Pseudo-norme v.g.v avec une métrique fixe
+template<typename T, size_t N>
+constexpr T pseudo_norm(const FixedTensor<T, N>& v, const FixedTensor<T, N, N>& g)
+{
+    return contract_with(v, contract_with(g, v));
+}
+
+#endif // TENSEURS_FIXED_H_INCLUDED
@@ -0,0 +1,446 @@
+///  -------------------------------------------------
+///  Binary tensor file format used by Tenseurs.h
+///  StandAlone, header only
+///  Coded by JP CHAMPEAUX
+///  contact : JPC@irsamc.upse-tlse.fr
+///  Free of use for Academic purpose only !
+///  (please, just mention author in your works if used or if your own code is inspired from it)
+///  --------------------------------------------------
+
+
+#ifndef TENSEURS_IO_H_INCLUDED
+#define TENSEURS_IO_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <complex>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/// Format de fichier (.tns) :
+///   [0, 64)            FileHeader
+///   [64, ...)          shape[rank], strides[rank] (uint64, en éléments)
+///   payload_offset     count éléments T bruts, aligné sur 64 octets (projetable tel quel)
+///   metric_offset      optionnel : rank, shape[rank] (uint64) puis les éléments de g
+/// Ordre des octets natif, vérifié au chargement.
+namespace tensor_io
+{
+
+constexpr size_t FILE_ALIGN = 64;
+constexpr uint32_t FILE_VERSION = 1;
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+constexpr char FILE_MAGIC[8] = {'T', 'E', 'N', 'S', 'E', 'U', 'R', '\x1a'};
+
+enum class DType : uint32_t
+{
+    Int8 = 1, UInt8, Int16, UInt16, Int32, UInt32, Int64, UInt64,
+    Float32, Float64, Bool, Complex64, Complex128
+};
+
+template<typename T, typename Enable = void>
+struct dtype_of;
+
+template<typename T>
+struct dtype_of<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type>
+{
+    static constexpr DType value = static_cast<DType>(
+        (sizeof(T) == 1 ? 1 : sizeof(T) == 2 ? 3 : sizeof(T) == 4 ? 5 : 7) + (std::is_signed<T>::value ? 0 : 1));
+};
+
+template<> struct dtype_of<bool> { static constexpr DType value = DType::Bool; };
+template<> struct dtype_of<float> { static constexpr DType value = DType::Float32; };
+template<> struct dtype_of<double> { static constexpr DType value = DType::Float64; };
+template<> struct dtype_of<std::complex<float>> { static constexpr DType value = DType::Complex64; };
+template<> struct dtype_of<std::complex<double>> { static constexpr DType value = DType::Complex128; };
+
+struct FileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t dtype;
+    uint32_t elem_size;
+    uint32_t rank;
+    uint32_t flags;            // réservé
+    uint64_t count;            // nombre d'éléments
+    uint64_t payload_offset;
+    uint64_t metric_offset;    // 0 : pas de métrique
+    uint64_t file_size;
+};
+
+static_assert(sizeof(FileHeader) == 64, "FileHeader must be 64 bytes");
+
+inline uint64_t align_up(uint64_t n)
+{
+    return (n + FILE_ALIGN - 1) / FILE_ALIGN * FILE_ALIGN;
+}
+
+template<typename T>
+void check_storable()
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Binary tensor files need a trivially copyable element type");
+    (void)dtype_of<T>::value;
+}
+
+/// Écriture en flux : en-tête, puis éléments ajoutés par morceaux (append), puis métrique (finish).
+/// g_shape == nullptr : pas de métrique.
+template<typename T>
+class FileWriter
+{
+    std::ofstream out;
+    std::string path;
+    FileHeader h;
+    std::vector<size_t> g_shape;
+    uint64_t written = 0;
+
+    void pad_to(uint64_t pos)
+    {
+        const char zeros[FILE_ALIGN] = {};
+        uint64_t here = static_cast<uint64_t>(out.tellp());
+        out.write(zeros, static_cast<std::streamsize>(pos - here));
+    }
+
+public:
+    FileWriter(const std::string& path_, const std::vector<size_t>& shape, const std::vector<size_t>& strides,
+               const std::vector<size_t>* g_shape_ = nullptr)
+        : out(path_, std::ios::binary | std::ios::trunc), path(path_)
+    {
+        check_storable<T>();
+        if (!out)
+            throw std::runtime_error("Cannot open tensor file for writing: " + path);
+
+        uint64_t count = 1;
+        for (size_t d : shape) count *= d;
+        uint64_t g_count = 1;
+        if (g_shape_)
+        {
+            g_shape = *g_shape_;
+            for (size_t d : g_shape) g_count *= d;
+        }
+
+        std::memcpy(h.magic, FILE_MAGIC, sizeof(h.magic));
+        h.version = FILE_VERSION;
+        h.byte_order = BYTE_ORDER_MARK;
+        h.dtype = static_cast<uint32_t>(dtype_of<T>::value);
+        h.elem_size = sizeof(T);
+        h.rank = static_cast<uint32_t>(shape.size());
+        h.flags = 0;
+        h.count = count;
+        h.payload_offset = align_up(sizeof(FileHeader) + 2 * shape.size() * sizeof(uint64_t));
+        uint64_t payload_end = h.payload_offset + count * sizeof(T);
+        h.metric_offset = g_shape_ ? align_up(payload_end) : 0;
+        h.file_size = g_shape_ ? h.metric_offset + (1 + g_shape.size()) * sizeof(uint64_t) + g_count * sizeof(T) : payload_end;
+
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        std::vector<uint64_t> dims(shape.begin(), shape.end());
+        dims.insert(dims.end(), strides.begin(), strides.end());
+        out.write(reinterpret_cast<const char*>(dims.data()), static_cast<std::streamsize>(dims.size() * sizeof(uint64_t)));
+        pad_to(h.payload_offset);
+    }
+
+    void append(const T* data, size_t n)
+    {
+        if (written + n > h.count)
+            throw std::runtime_error("Too many elements written to tensor file: " + path);
+        out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(n * sizeof(T)));
+        written += n;
+    }
+
+    // g_data : éléments de la métrique annoncée au constructeur
+    void finish(const T* g_data = nullptr)
+    {
+        if (written != h.count)
+            throw std::runtime_error("Tensor file is missing elements: " + path);
+        if (h.metric_offset)
+        {
+            uint64_t g_count = 1;
+            for (size_t d : g_shape) g_count *= d;
+            pad_to(h.metric_offset);
+            std::vector<uint64_t> g_dims(1, g_shape.size());
+            g_dims.insert(g_dims.end(), g_shape.begin(), g_shape.end());
+            out.write(reinterpret_cast<const char*>(g_dims.data()), static_cast<std::streamsize>(g_dims.size() * sizeof(uint64_t)));
+            out.write(reinterpret_cast<const char*>(g_data), static_cast<std::streamsize>(g_count * sizeof(T)));
+        }
+        out.flush();
+        if (!out)
+            throw std::runtime_error("Error while writing tensor file: " + path);
+    }
+};
+
+/// Écrit un tableau contigu (strides row-major) et sa métrique optionnelle (g_data == nullptr : aucune)
+template<typename T>
+void write_file(const std::string& path,
+                const T* data, const std::vector<size_t>& shape, const std::vector<size_t>& strides,
+                const T* g_data = nullptr, const std::vector<size_t>& g_shape = {})
+{
+    FileWriter<T> writer(path, shape, strides, g_data ? &g_shape : nullptr);
+    uint64_t count = 1;
+    for (size_t d : shape) count *= d;
+    writer.append(data, count);
+    writer.finish(g_data);
+}
+
+/// En-tête validé, shape et strides d'un fichier
+struct FileLayout
+{
+    FileHeader header;
+    std::vector<size_t> shape;
+    std::vector<size_t> strides;
+};
+
+/// Lit et vérifie l'en-tête depuis les premiers octets du fichier (size : taille du fichier)
+template<typename T>
+FileLayout parse_layout(const char* bytes, uint64_t size, const std::string& path)
+{
+    check_storable<T>();
+
+    FileLayout layout;
+    FileHeader& h = layout.header;
+    if (size < sizeof(FileHeader))
+        throw std::runtime_error("Not a tensor file: " + path);
+    std::memcpy(&h, bytes, sizeof(h));
+
+    if (std::memcmp(h.magic, FILE_MAGIC, sizeof(h.magic)) != 0)
+        throw std::runtime_error("Not a tensor file: " + path);
+    if (h.byte_order != BYTE_ORDER_MARK)
+        throw std::runtime_error("Tensor file has a different byte order: " + path);
+    if (h.version != FILE_VERSION)
+        throw std::runtime_error("Unsupported tensor file version: " + path);
+    if (h.dtype != static_cast<uint32_t>(dtype_of<T>::value) || h.elem_size != sizeof(T))
+        throw std::runtime_error("Tensor file element type mismatch: " + path);
+    // Taille du payload comparée par division : count * sizeof(T) pourrait déborder
+    if (h.file_size > size || sizeof(FileHeader) + 2 * uint64_t(h.rank) * sizeof(uint64_t) > h.payload_offset
+        || h.payload_offset % FILE_ALIGN != 0 || h.payload_offset > h.file_size
+        || h.count > (h.file_size - h.payload_offset) / sizeof(T))
+        throw std::runtime_error("Truncated or corrupt tensor file: " + path);
+
+    std::vector<uint64_t> dims(2 * h.rank);
+    std::memcpy(dims.data(), bytes + sizeof(FileHeader), dims.size() * sizeof(uint64_t));
+    layout.shape.assign(dims.begin(), dims.begin() + h.rank);
+    layout.strides.assign(dims.begin() + h.rank, dims.end());
+
+    // Tout élément adressé par (shape, strides) doit tomber dans le payload
+    uint64_t count = 1, last = 0;
+    for (size_t i = 0; i < h.rank; ++i)
+    {
+        count *= layout.shape[i];
+        if (layout.shape[i])
+            last += (layout.shape[i] - 1) * layout.strides[i];
+    }
+    if (count != h.count || (count && last >= h.count))
+        throw std::runtime_error("Truncated or corrupt tensor file: " + path);
+
+    return layout;
+}
+
+/// Lit le bloc métrique (block : octets à partir de metric_offset, length : octets disponibles)
+template<typename T>
+void parse_metric(const char* block, uint64_t length, std::vector<size_t>& g_shape, std::vector<T>& g_data,
+                  const std::string& path)
+{
+    auto fail = [&] { throw std::runtime_error("Truncated or corrupt tensor file: " + path); };
+    if (length < sizeof(uint64_t))
+        fail();
+
+    uint64_t g_rank;
+    std::memcpy(&g_rank, block, sizeof(uint64_t));
+    uint64_t pos = sizeof(uint64_t);
+    if (g_rank > (length - pos) / sizeof(uint64_t))
+        fail();
+
+    std::vector<uint64_t> dims(g_rank);
+    std::memcpy(dims.data(), block + pos, g_rank * sizeof(uint64_t));
+    pos += g_rank * sizeof(uint64_t);
+
+    uint64_t g_count = 1;
+    for (uint64_t d : dims) g_count *= d;
+    if (g_count > (length - pos) / sizeof(T))
+        fail();
+
+    g_shape.assign(dims.begin(), dims.end());
+    g_data.resize(g_count);
+    std::memcpy(g_data.data(), block + pos, g_count * sizeof(T));
+}
+
+/// Ouvre un fichier et valide son en-tête ; in est laissé ouvert pour lire payload et métrique
+template<typename T>
+FileLayout open_file(const std::string& path, std::ifstream& in)
+{
+    in.open(path, std::ios::binary | std::ios::ate);
+    if (!in)
+        throw std::runtime_error("Cannot open tensor file: " + path);
+    uint64_t size = static_cast<uint64_t>(in.tellg());
+    in.seekg(0);
+
+    FileHeader h;
+    if (size < sizeof(FileHeader) || !in.read(reinterpret_cast<char*>(&h), sizeof(h)))
+        throw std::runtime_error("Not a tensor file: " + path);
+    uint64_t prefix = sizeof(FileHeader) + 2 * uint64_t(h.rank) * sizeof(uint64_t);
+    if (prefix > size)
+        throw std::runtime_error("Truncated or corrupt tensor file: " + path);
+
+    std::vector<char> bytes(prefix);
+    std::memcpy(bytes.data(), &h, sizeof(h));
+    in.read(bytes.data() + sizeof(h), static_cast<std::streamsize>(prefix - sizeof(h)));
+    return parse_layout<T>(bytes.data(), size, path);
+}
+
+/// Lit la métrique d'un fichier ouvert par open_file (g_shape vide : pas de métrique)
+template<typename T>
+void read_metric(const std::string& path, std::ifstream& in, const FileHeader& h,
+                 std::vector<size_t>& g_shape, std::vector<T>& g_data)
+{
+    g_shape.clear();
+    g_data.clear();
+    if (!h.metric_offset)
+        return;
+    if (h.metric_offset > h.file_size)
+        throw std::runtime_error("Truncated or corrupt tensor file: " + path);
+    std::vector<char> block(h.file_size - h.metric_offset);
+    in.seekg(static_cast<std::streamoff>(h.metric_offset));
+    in.read(block.data(), static_cast<std::streamsize>(block.size()));
+    parse_metric(block.data(), block.size(), g_shape, g_data, path);
+}
+
+/// Lit count éléments à partir de l'élément first du payload
+template<typename T>
+void read_elements(const std::string& path, std::ifstream& in, const FileHeader& h, uint64_t first, uint64_t count, T* dst)
+{
+    in.seekg(static_cast<std::streamoff>(h.payload_offset + first * sizeof(T)));
+    in.read(reinterpret_cast<char*>(dst), static_cast<std::streamsize>(count * sizeof(T)));
+    if (!in)
+        throw std::runtime_error("Error while reading tensor file: " + path);
+}
+
+/// Lecture complète : les éléments sont lus d'un bloc directement dans payload (vector ou CowBuffer)
+template<typename T, typename Buffer>
+FileLayout read_file(const std::string& path, Buffer& payload, std::vector<size_t>& g_shape, std::vector<T>& g_data)
+{
+    std::ifstream in;
+    FileLayout layout = open_file<T>(path, in);
+    payload.resize(layout.header.count);
+    read_elements(path, in, layout.header, 0, layout.header.count, payload.data());
+    read_metric(path, in, layout.header, g_shape, g_data);
+    if (!in)
+        throw std::runtime_error("Error while reading tensor file: " + path);
+    return layout;
+}
+
+/// Projection d'un fichier en mémoire, en lecture seule ou en copie à l'écriture
+/// (les écritures restent privées au processus et ne touchent jamais le fichier).
+/// Aucune lecture : les pages sont chargées par le système au premier accès.
+class MappedFile
+{
+    char* bytes = nullptr;
+    uint64_t length = 0;
+    bool writable = false;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+
+public:
+    MappedFile(const std::string& path, bool copy_on_write)
+        : writable(copy_on_write)
+    {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            throw std::runtime_error("Cannot open tensor file: " + path);
+        LARGE_INTEGER file_size;
+        GetFileSizeEx(file, &file_size);
+        length = static_cast<uint64_t>(file_size.QuadPart);
+        if (length)
+        {
+            mapping = CreateFileMappingA(file, nullptr, copy_on_write ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr);
+            if (mapping)
+                bytes = static_cast<char*>(MapViewOfFile(mapping, copy_on_write ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0));
+            if (!bytes)
+            {
+                release();
+                throw std::runtime_error("Cannot map tensor file: " + path);
+            }
+        }
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("Cannot open tensor file: " + path);
+        struct stat st;
+        if (::fstat(fd, &st) != 0)
+        {
+            ::close(fd);
+            throw std::runtime_error("Cannot open tensor file: " + path);
+        }
+        length = static_cast<uint64_t>(st.st_size);
+        if (length)
+        {
+            void* p = ::mmap(nullptr, length, PROT_READ | (copy_on_write ? PROT_WRITE : 0), MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED)
+            {
+                ::close(fd);
+                throw std::runtime_error("Cannot map tensor file: " + path);
+            }
+            bytes = static_cast<char*>(p);
+        }
+        ::close(fd);  // la projection reste valide
+#endif
+    }
+
+    ~MappedFile()
+    {
+        release();
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    char* data() const
+    {
+        return bytes;
+    }
+
+    uint64_t size() const
+    {
+        return length;
+    }
+
+    bool is_writable() const
+    {
+        return writable;
+    }
+
+private:
+    void release()
+    {
+#ifdef _WIN32
+        if (bytes) UnmapViewOfFile(bytes);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (bytes) ::munmap(bytes, length);
+#endif
+        bytes = nullptr;
+    }
+};
+
+} // namespace tensor_io
+
+#endif // TENSEURS_IO_H_INCLUDED
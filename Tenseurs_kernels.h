@@ -0,0 +1,798 @@
+///  -------------------------------------------------
+///  Low level kernels used by Tenseurs.h
+///  StandAlone, header only
+///  Coded by JP CHAMPEAUX
+///  contact : JPC@irsamc.upse-tlse.fr
+///  Free of use for Academic purpose only !
+///  (please, just mention author in your works if used or if your own code is inspired from it)
+///  --------------------------------------------------
+
+
+#ifndef TENSEURS_KERNELS_H_INCLUDED
+#define TENSEURS_KERNELS_H_INCLUDED
+
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include <cstddef>
+#include <cstring>
+
+#include "Tenseurs_parallel.h"
+
+// Noyaux SIMD : extensions vectorielles GCC/Clang, choix AVX-512 / AVX2 / SSE à l'exécution.
+// -DTENSOR_NO_SIMD force les boucles scalaires.
+#if defined(__GNUC__) && !defined(TENSOR_NO_SIMD)
+#define TENSOR_SIMD_VECTOR_EXT 1
+#define TENSOR_ALWAYS_INLINE inline __attribute__((always_inline))
+#if defined(__x86_64__) || defined(__i386__)
+#define TENSOR_SIMD_X86 1
+#endif
+#endif
+
+#ifndef TENSOR_ALWAYS_INLINE
+#define TENSOR_ALWAYS_INLINE inline
+#endif
+
+namespace tensor_kernels
+{
+
+/// C (M x N) = A (M x K) * B (K x N), row-major, lda/ldb/ldc = pas entre deux lignes.
+/// Version générique (Symbole, ...) : le premier terme initialise la somme, pas de T{} ajouté.
+template<typename T>
+void gemm_generic(size_t M, size_t N, size_t K,
+                  const T* A, size_t lda, const T* B, size_t ldb, T* C, size_t ldc)
+{
+    for (size_t i = 0; i < M; ++i)
+    {
+        for (size_t j = 0; j < N; ++j)
+        {
+            if (K == 0)
+            {
+                C[i * ldc + j] = T{};
+                continue;
+            }
+            T acc = A[i * lda] * B[j];
+            for (size_t p = 1; p < K; ++p)
+                acc = acc + A[i * lda + p] * B[p * ldb + j];
+            C[i * ldc + j] = acc;
+        }
+    }
+}
+
+// Tailles de blocs : un panneau KC x NR de B tient en L1, un bloc MC x KC de A en L2
+constexpr size_t GEMM_MR = 4;
+constexpr size_t GEMM_NR = 8;
+constexpr size_t GEMM_MC = 128;
+constexpr size_t GEMM_KC = 256;
+constexpr size_t GEMM_NC = 2048;
+
+// Recopie un bloc mc x kc de A en panneaux de MR lignes (colonne par colonne, complétés par des 0)
+template<typename T>
+void gemm_pack_A(size_t mc, size_t kc, const T* A, size_t lda, T* packed)
+{
+    for (size_t i = 0; i < mc; i += GEMM_MR)
+    {
+        size_t mr = std::min(GEMM_MR, mc - i);
+        for (size_t p = 0; p < kc; ++p)
+        {
+            for (size_t r = 0; r < mr; ++r)
+                *packed++ = A[(i + r) * lda + p];
+            for (size_t r = mr; r < GEMM_MR; ++r)
+                *packed++ = T(0);
+        }
+    }
+}
+
+// Recopie un bloc kc x nc de B en panneaux de NR colonnes (ligne par ligne, complétés par des 0)
+template<typename T>
+void gemm_pack_B(size_t kc, size_t nc, const T* B, size_t ldb, T* packed)
+{
+    for (size_t j = 0; j < nc; j += GEMM_NR)
+    {
+        size_t nr = std::min(GEMM_NR, nc - j);
+        for (size_t p = 0; p < kc; ++p)
+        {
+            const T* row = B + p * ldb + j;
+            for (size_t c = 0; c < nr; ++c)
+                *packed++ = row[c];
+            for (size_t c = nr; c < GEMM_NR; ++c)
+                *packed++ = T(0);
+        }
+    }
+}
+
+// Micro-noyau MR x NR : les accumulateurs restent en registres sur toute la profondeur kc
+template<typename T>
+void gemm_micro_kernel(size_t kc, const T* a, const T* b, T* C, size_t ldc, size_t mr, size_t nr)
+{
+    T acc[GEMM_MR][GEMM_NR] = {};
+    for (size_t p = 0; p < kc; ++p)
+    {
+        for (size_t r = 0; r < GEMM_MR; ++r)
+        {
+            T ar = a[r];
+            for (size_t c = 0; c < GEMM_NR; ++c)
+                acc[r][c] += ar * b[c];
+        }
+        a += GEMM_MR;
+        b += GEMM_NR;
+    }
+    for (size_t r = 0; r < mr; ++r)
+        for (size_t c = 0; c < nr; ++c)
+            C[r * ldc + c] += acc[r][c];
+}
+
+/// Version bloquée (types arithmétiques) : découpage NC / KC / MC, panneaux recopiés, micro-noyau MR x NR.
+template<typename T>
+void gemm_blocked(size_t M, size_t N, size_t K,
+                  const T* A, size_t lda, const T* B, size_t ldb, T* C, size_t ldc)
+{
+    for (size_t i = 0; i < M; ++i)
+        std::fill(C + i * ldc, C + i * ldc + N, T(0));
+    if (M == 0 || N == 0 || K == 0)
+        return;
+
+    std::vector<T> packed_A(GEMM_MC * GEMM_KC);
+    std::vector<T> packed_B(GEMM_KC * ((std::min(N, GEMM_NC) + GEMM_NR - 1) / GEMM_NR) * GEMM_NR);
+
+    for (size_t jc = 0; jc < N; jc += GEMM_NC)
+    {
+        size_t nc = std::min(GEMM_NC, N - jc);
+        for (size_t pc = 0; pc < K; pc += GEMM_KC)
+        {
+            size_t kc = std::min(GEMM_KC, K - pc);
+            gemm_pack_B(kc, nc, B + pc * ldb + jc, ldb, packed_B.data());
+
+            for (size_t ic = 0; ic < M; ic += GEMM_MC)
+            {
+                size_t mc = std::min(GEMM_MC, M - ic);
+                gemm_pack_A(mc, kc, A + ic * lda + pc, lda, packed_A.data());
+
+                for (size_t jr = 0; jr < nc; jr += GEMM_NR)
+                {
+                    size_t nr = std::min(GEMM_NR, nc - jr);
+                    const T* b = packed_B.data() + jr * kc;
+                    for (size_t ir = 0; ir < mc; ir += GEMM_MR)
+                    {
+                        size_t mr = std::min(GEMM_MR, mc - ir);
+                        const T* a = packed_A.data() + ir * kc;
+                        gemm_micro_kernel(kc, a, b, C + (ic + ir) * ldc + jc + jr, ldc, mr, nr);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Tuiles de C traitées par une tâche du pool de threads
+constexpr size_t GEMM_TILE_M = GEMM_MC;
+constexpr size_t GEMM_TILE_N = 256;
+
+/// C = A * B : noyau bloqué pour les types arithmétiques, boucle générique sinon.
+/// Au-delà de quelques millions de multiplications, C est découpé en tuiles
+/// GEMM_TILE_M x GEMM_TILE_N réparties sur le pool de threads (chaque tuile recopie ses panneaux).
+template<typename T>
+void gemm(size_t M, size_t N, size_t K,
+          const T* A, size_t lda, const T* B, size_t ldb, T* C, size_t ldc)
+{
+    if constexpr (std::is_arithmetic<T>::value)
+    {
+        size_t tiles_m = (M + GEMM_TILE_M - 1) / GEMM_TILE_M;
+        size_t tiles_n = (N + GEMM_TILE_N - 1) / GEMM_TILE_N;
+        if (M * N * K < PARALLEL_GRAIN * 64 || tiles_m * tiles_n == 1 || num_threads() == 1)
+        {
+            gemm_blocked(M, N, K, A, lda, B, ldb, C, ldc);
+            return;
+        }
+
+        parallel_for(0, tiles_m * tiles_n, 1, [&](size_t t0, size_t t1)
+        {
+            for (size_t t = t0; t < t1; ++t)
+            {
+                size_t i0 = (t / tiles_n) * GEMM_TILE_M;
+                size_t j0 = (t % tiles_n) * GEMM_TILE_N;
+                gemm_blocked(std::min(GEMM_TILE_M, M - i0), std::min(GEMM_TILE_N, N - j0), K,
+                             A + i0 * lda, lda, B + j0, ldb, C + i0 * ldc + j0, ldc);
+            }
+        });
+    }
+    else
+    {
+        gemm_generic(M, N, K, A, lda, B, ldb, C, ldc);
+    }
+}
+
+/// ----------------------------------------------------------------
+/// Noyaux par lots : batch petits problèmes indépendants, un seul passage
+/// ----------------------------------------------------------------
+
+// C = A * B pour de petites matrices : aucune allocation.
+// N petit (produit matrice-vecteur, ...) : produits scalaires, l'accumulateur reste en registre ;
+// sinon boucle interne contiguë sur N. Types génériques (Symbole, ...) : gemm_generic, sans T(0) ni +=
+template<typename T>
+void small_gemm(size_t M, size_t N, size_t K, const T* A, const T* B, T* C)
+{
+    if constexpr (!std::is_arithmetic<T>::value)
+    {
+        gemm_generic(M, N, K, A, K, B, N, C, N);
+    }
+    else if (N < 8)
+    {
+        for (size_t i = 0; i < M; ++i)
+            for (size_t j = 0; j < N; ++j)
+            {
+                T acc = T(0);
+                for (size_t k = 0; k < K; ++k)
+                    acc += A[i * K + k] * B[k * N + j];
+                C[i * N + j] = acc;
+            }
+    }
+    else
+    {
+        for (size_t i = 0; i < M; ++i)
+        {
+            T* c = C + i * N;
+            std::fill(c, c + N, T(0));
+            for (size_t k = 0; k < K; ++k)
+            {
+                const T a = A[i * K + k];
+                const T* b = B + k * N;
+                for (size_t j = 0; j < N; ++j)
+                    c[j] += a * b[j];
+            }
+        }
+    }
+}
+
+/// C[b] = A[b] * B[b] pour b < batch, matrices row-major contiguës.
+/// Un pas nul partage l'opérande entre tous les lots (même opérateur appliqué à chaque élément).
+/// Petits problèmes : lots répartis sur le pool ; grands : un GEMM bloqué (parallèle) par lot.
+template<typename T>
+void batched_gemm(size_t batch, size_t M, size_t N, size_t K,
+                  const T* A, size_t stride_A, const T* B, size_t stride_B, T* C, size_t stride_C)
+{
+    const size_t work = std::max<size_t>(1, M * N * K);
+    if (work >= PARALLEL_GRAIN)
+    {
+        for (size_t b = 0; b < batch; ++b)
+            gemm(M, N, K, A + b * stride_A, K, B + b * stride_B, N, C + b * stride_C, N);
+        return;
+    }
+
+    size_t grain = std::is_arithmetic<T>::value ? std::max<size_t>(1, PARALLEL_GRAIN / work) : batch;
+    parallel_for(0, batch, grain, [&](size_t b0, size_t b1)
+    {
+        for (size_t b = b0; b < b1; ++b)
+            small_gemm(M, N, K, A + b * stride_A, B + b * stride_B, C + b * stride_C);
+    });
+}
+
+// Lignes de D éléments connus à la compilation : boucle interne déroulée
+template<typename T, size_t D>
+void quadratic_rows_fixed(size_t r0, size_t r1, const T* x, const T* diag, const T* full, T* out)
+{
+    T w[D];
+    for (size_t k = 0; k < D; ++k)
+        w[k] = diag ? diag[k] : T(1);
+
+    for (size_t r = r0; r < r1; ++r)
+    {
+        const T* v = x + r * D;
+        T acc = T(0);
+        if (full)
+        {
+            for (size_t i = 0; i < D; ++i)
+            {
+                T gv = T(0);
+                for (size_t j = 0; j < D; ++j)
+                    gv += full[i * D + j] * v[j];
+                acc += v[i] * gv;
+            }
+        }
+        else
+        {
+            for (size_t k = 0; k < D; ++k)
+                acc += w[k] * v[k] * v[k];
+        }
+        out[r] = acc;
+    }
+}
+
+// Types génériques (Symbole, ...) : chaque somme part de son premier terme, sans T(0) ni +=
+template<typename T>
+void quadratic_rows_generic(size_t r0, size_t r1, size_t d, const T* x, const T* diag, const T* full, T* out)
+{
+    for (size_t r = r0; r < r1; ++r)
+    {
+        const T* v = x + r * d;
+        T acc{};
+        for (size_t i = 0; i < d; ++i)
+        {
+            T gv = v[i];
+            if (full)
+            {
+                gv = full[i * d] * v[0];
+                for (size_t j = 1; j < d; ++j)
+                    gv = gv + full[i * d + j] * v[j];
+            }
+            else if (diag)
+                gv = diag[i] * v[i];
+            acc = i ? acc + v[i] * gv : v[i] * gv;
+        }
+        out[r] = acc;
+    }
+}
+
+template<typename T>
+void quadratic_rows(size_t r0, size_t r1, size_t d, const T* x, const T* diag, const T* full, T* out)
+{
+    for (size_t r = r0; r < r1; ++r)
+    {
+        const T* v = x + r * d;
+        T acc = T(0);
+        if (full)
+        {
+            for (size_t i = 0; i < d; ++i)
+            {
+                T gv = T(0);
+                for (size_t j = 0; j < d; ++j)
+                    gv += full[i * d + j] * v[j];
+                acc += v[i] * gv;
+            }
+        }
+        else if (diag)
+        {
+            for (size_t k = 0; k < d; ++k)
+                acc += diag[k] * v[k] * v[k];
+        }
+        else
+        {
+            for (size_t k = 0; k < d; ++k)
+                acc += v[k] * v[k];
+        }
+        out[r] = acc;
+    }
+}
+
+/// out[r] = x_r^T G x_r pour rows lignes de d éléments (pseudo-normes par lots).
+/// G pleine (full, d x d), diagonale (diag, d éléments) ou identité (les deux nuls).
+/// Un seul passage sur x ; d = 2, 3, 4 déroulés (quadrivecteurs de Minkowski).
+template<typename T>
+void batched_quadratic(size_t rows, size_t d, const T* x, const T* diag, const T* full, T* out)
+{
+    size_t grain = std::is_arithmetic<T>::value ? std::max<size_t>(1, PARALLEL_GRAIN / std::max<size_t>(1, d)) : rows;
+    parallel_for(0, rows, grain, [&](size_t r0, size_t r1)
+    {
+        if constexpr (!std::is_arithmetic<T>::value)
+        {
+            quadratic_rows_generic(r0, r1, d, x, diag, full, out);
+        }
+        else
+        {
+            switch (d)
+            {
+            case 2: quadratic_rows_fixed<T, 2>(r0, r1, x, diag, full, out); break;
+            case 3: quadratic_rows_fixed<T, 3>(r0, r1, x, diag, full, out); break;
+            case 4: quadratic_rows_fixed<T, 4>(r0, r1, x, diag, full, out); break;
+            default: quadratic_rows(r0, r1, d, x, diag, full, out); break;
+            }
+        }
+    });
+}
+
+/// ----------------------------------------------------------------
+/// Copie d'une vue à pas quelconques dans un buffer row-major (contiguous, permute)
+/// ----------------------------------------------------------------
+
+// Côté d'une tuile de la transposition 2D : une tuile source et une tuile destination tiennent en L1
+constexpr size_t TRANSPOSE_TILE = 32;
+
+/// Supprime les axes de taille 1 et fusionne les axes consécutifs contigus dans la source.
+/// Les axes restants parcourent les mêmes éléments dans le même ordre row-major.
+inline void collapse_axes(std::vector<size_t>& shape, std::vector<size_t>& strides)
+{
+    std::vector<size_t> merged_shape, merged_strides;
+    for (size_t d = 0; d < shape.size(); ++d)
+    {
+        if (shape[d] == 1)
+            continue;
+        if (!merged_shape.empty() && merged_strides.back() == strides[d] * shape[d])
+        {
+            merged_shape.back() *= shape[d];
+            merged_strides.back() = strides[d];
+        }
+        else
+        {
+            merged_shape.push_back(shape[d]);
+            merged_strides.push_back(strides[d]);
+        }
+    }
+    shape.swap(merged_shape);
+    strides.swap(merged_strides);
+}
+
+/// dst (row-major, forme shape) = éléments de src lus avec les pas strides.
+/// Après fusion des axes : copie de lignes contiguës quand le dernier axe est de pas 1,
+/// sinon transposition par tuiles entre l'axe de pas 1 de la source et le dernier axe,
+/// le reste étant parcouru par compteur incrémental. Réparti sur le pool de threads
+/// pour les types arithmétiques.
+template<typename T>
+void strided_copy(const T* src, std::vector<size_t> shape, std::vector<size_t> strides, T* dst)
+{
+    size_t total = 1;
+    for (size_t n : shape)
+        total *= n;
+    if (total == 0)
+        return;
+
+    collapse_axes(shape, strides);
+    size_t nd = shape.size();
+    if (nd == 0)
+    {
+        dst[0] = src[0];
+        return;
+    }
+    size_t grain = std::is_arithmetic<T>::value ? PARALLEL_GRAIN : total;
+    size_t last = nd - 1;
+
+    if (nd == 1)
+    {
+        size_t step = strides[0];
+        parallel_for(0, total, grain, [&](size_t lo, size_t hi)
+        {
+            if (step == 1)
+                std::copy(src + lo, src + hi, dst + lo);
+            else
+                for (size_t i = lo; i < hi; ++i)
+                    dst[i] = src[i * step];
+        });
+        return;
+    }
+
+    // Axe de pas 1 dans la source, autre que le dernier : coeur de transposition
+    size_t p = nd;
+    if (strides[last] != 1)
+        for (size_t d = 0; d < last; ++d)
+            if (strides[d] == 1)
+                p = d;
+
+    // Pas de la destination (row-major sur la forme fusionnée)
+    std::vector<size_t> dst_strides(nd);
+    for (size_t d = nd, stride = 1; d-- > 0; stride *= shape[d])
+        dst_strides[d] = stride;
+
+    if (p == nd)
+    {
+        // Une ligne (dernier axe) par indice externe : copie directe si elle est contiguë
+        size_t inner = shape[last], step = strides[last];
+        parallel_for(0, total / inner, std::max<size_t>(1, grain / inner), [&](size_t r0, size_t r1)
+        {
+            std::vector<size_t> idx(last, 0);
+            size_t off = 0;
+            for (size_t d = last, r = r0; d-- > 0; r /= shape[d])
+            {
+                idx[d] = r % shape[d];
+                off += idx[d] * strides[d];
+            }
+
+            for (size_t r = r0; r < r1; ++r)
+            {
+                const T* s = src + off;
+                T* o = dst + r * inner;
+                if (step == 1)
+                    std::copy(s, s + inner, o);
+                else
+                    for (size_t j = 0; j < inner; ++j)
+                        o[j] = s[j * step];
+
+                for (size_t d = last; d-- > 0;)
+                {
+                    if (++idx[d] < shape[d])
+                    {
+                        off += strides[d];
+                        break;
+                    }
+                    off -= (shape[d] - 1) * strides[d];
+                    idx[d] = 0;
+                }
+            }
+        });
+        return;
+    }
+
+    // Transposition 2D par tuiles : lecture contiguë selon p, écriture contiguë selon le dernier axe.
+    // Une tâche = une bande de TRANSPOSE_TILE indices de p pour un indice des autres axes.
+    size_t np = shape[p], nl = shape[last];
+    size_t sl = strides[last], dp = dst_strides[p];
+    size_t bands = (np + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE;
+    size_t outer = total / (np * nl);
+    parallel_for(0, outer * bands, std::max<size_t>(1, grain / (TRANSPOSE_TILE * nl)), [&](size_t t0, size_t t1)
+    {
+        for (size_t t = t0; t < t1; ++t)
+        {
+            size_t src_off = 0, dst_off = 0;
+            for (size_t d = last, o = t / bands; d-- > 0;)
+            {
+                if (d == p)
+                    continue;
+                size_t i = o % shape[d];
+                o /= shape[d];
+                src_off += i * strides[d];
+                dst_off += i * dst_strides[d];
+            }
+
+            size_t i0 = (t % bands) * TRANSPOSE_TILE;
+            size_t i1 = std::min(np, i0 + TRANSPOSE_TILE);
+            for (size_t j0 = 0; j0 < nl; j0 += TRANSPOSE_TILE)
+            {
+                size_t j1 = std::min(nl, j0 + TRANSPOSE_TILE);
+                for (size_t i = i0; i < i1; ++i)
+                {
+                    const T* s = src + src_off + i;
+                    T* o = dst + dst_off + i * dp;
+                    for (size_t j = j0; j < j1; ++j)
+                        o[j] = s[j * sl];
+                }
+            }
+        }
+    });
+}
+
+/// ----------------------------------------------------------------
+/// Noyaux élément par élément et réductions pour float / double
+/// ----------------------------------------------------------------
+
+enum class ElementOp
+{
+    Add,
+    Sub,
+    Mul,
+    Div
+};
+
+template<typename T>
+struct is_simd_type : std::integral_constant<bool, std::is_same<T, float>::value || std::is_same<T, double>::value>
+{
+};
+
+// Résultat passé par référence : pas de vecteur passé par valeur entre cibles différentes (ABI)
+template<ElementOp Op, typename V>
+TENSOR_ALWAYS_INLINE void apply_op(V& r, const V& a, const V& b)
+{
+    if constexpr (Op == ElementOp::Add)
+        r = a + b;
+    else if constexpr (Op == ElementOp::Sub)
+        r = a - b;
+    else if constexpr (Op == ElementOp::Mul)
+        r = a * b;
+    else
+        r = a / b;
+}
+
+#ifdef TENSOR_SIMD_VECTOR_EXT
+
+template<typename T, size_t Bytes>
+struct simd_vec
+{
+    typedef T type __attribute__((vector_size(Bytes)));
+};
+
+// Boucles génériques sur des vecteurs de Bytes octets ; toujours inlinées dans les
+// fonctions compilées pour une cible donnée (avx512f, avx2, défaut)
+template<ElementOp Op, typename T, size_t Bytes>
+TENSOR_ALWAYS_INLINE void binary_loop(const T* a, const T* b, T* out, size_t n)
+{
+    using V = typename simd_vec<T, Bytes>::type;
+    constexpr size_t W = Bytes / sizeof(T);
+    size_t i = 0;
+    for (; i + W <= n; i += W)
+    {
+        V va, vb;
+        std::memcpy(&va, a + i, Bytes);
+        std::memcpy(&vb, b + i, Bytes);
+        V r;
+        apply_op<Op>(r, va, vb);
+        std::memcpy(out + i, &r, Bytes);
+    }
+    for (; i < n; ++i)
+        apply_op<Op>(out[i], a[i], b[i]);
+}
+
+template<ElementOp Op, typename T, size_t Bytes>
+TENSOR_ALWAYS_INLINE void binary_scalar_loop(const T* a, T s, T* out, size_t n)
+{
+    using V = typename simd_vec<T, Bytes>::type;
+    constexpr size_t W = Bytes / sizeof(T);
+    V vs = V{} + s;
+    size_t i = 0;
+    for (; i + W <= n; i += W)
+    {
+        V va;
+        std::memcpy(&va, a + i, Bytes);
+        V r;
+        apply_op<Op>(r, va, vs);
+        std::memcpy(out + i, &r, Bytes);
+    }
+    for (; i < n; ++i)
+        apply_op<Op>(out[i], a[i], s);
+}
+
+// Réduction : 4 accumulateurs vectoriels indépendants (l'ordre des additions change)
+template<bool Squares, typename T, size_t Bytes>
+TENSOR_ALWAYS_INLINE T reduce_loop(const T* a, size_t n)
+{
+    using V = typename simd_vec<T, Bytes>::type;
+    constexpr size_t W = Bytes / sizeof(T);
+    V acc0 = {}, acc1 = {}, acc2 = {}, acc3 = {};
+    size_t i = 0;
+    for (; i + 4 * W <= n; i += 4 * W)
+    {
+        V v0, v1, v2, v3;
+        std::memcpy(&v0, a + i, Bytes);
+        std::memcpy(&v1, a + i + W, Bytes);
+        std::memcpy(&v2, a + i + 2 * W, Bytes);
+        std::memcpy(&v3, a + i + 3 * W, Bytes);
+        if constexpr (Squares)
+        {
+            acc0 += v0 * v0;
+            acc1 += v1 * v1;
+            acc2 += v2 * v2;
+            acc3 += v3 * v3;
+        }
+        else
+        {
+            acc0 += v0;
+            acc1 += v1;
+            acc2 += v2;
+            acc3 += v3;
+        }
+    }
+    acc0 = (acc0 + acc1) + (acc2 + acc3);
+    for (; i + W <= n; i += W)
+    {
+        V v;
+        std::memcpy(&v, a + i, Bytes);
+        acc0 += Squares ? v * v : v;
+    }
+    T result = T(0);
+    for (size_t l = 0; l < W; ++l)
+        result += acc0[l];
+    for (; i < n; ++i)
+        result += Squares ? a[i] * a[i] : a[i];
+    return result;
+}
+
+template<typename T, size_t Bytes>
+TENSOR_ALWAYS_INLINE void binary_dispatch(ElementOp op, const T* a, const T* b, T* out, size_t n)
+{
+    switch (op)
+    {
+    case ElementOp::Add: binary_loop<ElementOp::Add, T, Bytes>(a, b, out, n); break;
+    case ElementOp::Sub: binary_loop<ElementOp::Sub, T, Bytes>(a, b, out, n); break;
+    case ElementOp::Mul: binary_loop<ElementOp::Mul, T, Bytes>(a, b, out, n); break;
+    case ElementOp::Div: binary_loop<ElementOp::Div, T, Bytes>(a, b, out, n); break;
+    }
+}
+
+template<typename T, size_t Bytes>
+TENSOR_ALWAYS_INLINE void binary_scalar_dispatch(ElementOp op, const T* a, T s, T* out, size_t n)
+{
+    switch (op)
+    {
+    case ElementOp::Add: binary_scalar_loop<ElementOp::Add, T, Bytes>(a, s, out, n); break;
+    case ElementOp::Sub: binary_scalar_loop<ElementOp::Sub, T, Bytes>(a, s, out, n); break;
+    case ElementOp::Mul: binary_scalar_loop<ElementOp::Mul, T, Bytes>(a, s, out, n); break;
+    case ElementOp::Div: binary_scalar_loop<ElementOp::Div, T, Bytes>(a, s, out, n); break;
+    }
+}
+
+// Cible par défaut : vecteurs 16 octets (SSE2 sur x86-64, NEON sur ARM)
+template<typename T> void binary_base(ElementOp op, const T* a, const T* b, T* out, size_t n) { binary_dispatch<T, 16>(op, a, b, out, n); }
+template<typename T> void binary_scalar_base(ElementOp op, const T* a, T s, T* out, size_t n) { binary_scalar_dispatch<T, 16>(op, a, s, out, n); }
+template<typename T> T sum_base(const T* a, size_t n) { return reduce_loop<false, T, 16>(a, n); }
+template<typename T> T sum_squares_base(const T* a, size_t n) { return reduce_loop<true, T, 16>(a, n); }
+
+#ifdef TENSOR_SIMD_X86
+template<typename T> __attribute__((target("avx2,fma"))) void binary_avx2(ElementOp op, const T* a, const T* b, T* out, size_t n) { binary_dispatch<T, 32>(op, a, b, out, n); }
+template<typename T> __attribute__((target("avx2,fma"))) void binary_scalar_avx2(ElementOp op, const T* a, T s, T* out, size_t n) { binary_scalar_dispatch<T, 32>(op, a, s, out, n); }
+template<typename T> __attribute__((target("avx2,fma"))) T sum_avx2(const T* a, size_t n) { return reduce_loop<false, T, 32>(a, n); }
+template<typename T> __attribute__((target("avx2,fma"))) T sum_squares_avx2(const T* a, size_t n) { return reduce_loop<true, T, 32>(a, n); }
+
+template<typename T> __attribute__((target("avx512f"))) void binary_avx512(ElementOp op, const T* a, const T* b, T* out, size_t n) { binary_dispatch<T, 64>(op, a, b, out, n); }
+template<typename T> __attribute__((target("avx512f"))) void binary_scalar_avx512(ElementOp op, const T* a, T s, T* out, size_t n) { binary_scalar_dispatch<T, 64>(op, a, s, out, n); }
+template<typename T> __attribute__((target("avx512f"))) T sum_avx512(const T* a, size_t n) { return reduce_loop<false, T, 64>(a, n); }
+template<typename T> __attribute__((target("avx512f"))) T sum_squares_avx512(const T* a, size_t n) { return reduce_loop<true, T, 64>(a, n); }
+#endif
+
+#else
+
+// Compilateur sans extensions vectorielles : boucles scalaires
+template<typename T>
+void binary_base(ElementOp op, const T* a, const T* b, T* out, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        switch (op)
+        {
+        case ElementOp::Add: out[i] = a[i] + b[i]; break;
+        case ElementOp::Sub: out[i] = a[i] - b[i]; break;
+        case ElementOp::Mul: out[i] = a[i] * b[i]; break;
+        case ElementOp::Div: out[i] = a[i] / b[i]; break;
+        }
+    }
+}
+
+template<typename T>
+void binary_scalar_base(ElementOp op, const T* a, T s, T* out, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        switch (op)
+        {
+        case ElementOp::Add: out[i] = a[i] + s; break;
+        case ElementOp::Sub: out[i] = a[i] - s; break;
+        case ElementOp::Mul: out[i] = a[i] * s; break;
+        case ElementOp::Div: out[i] = a[i] / s; break;
+        }
+    }
+}
+
+template<typename T>
+T sum_base(const T* a, size_t n)
+{
+    T acc = T(0);
+    for (size_t i = 0; i < n; ++i)
+        acc += a[i];
+    return acc;
+}
+
+template<typename T>
+T sum_squares_base(const T* a, size_t n)
+{
+    T acc = T(0);
+    for (size_t i = 0; i < n; ++i)
+        acc += a[i] * a[i];
+    return acc;
+}
+
+#endif
+
+/// Table de noyaux choisie une seule fois selon le processeur
+template<typename T>
+struct SimdKernels
+{
+    void (*binary)(ElementOp, const T*, const T*, T*, size_t);
+    void (*binary_scalar)(ElementOp, const T*, T, T*, size_t);
+    T (*sum)(const T*, size_t);
+    T (*sum_squares)(const T*, size_t);
+    const char* name;
+};
+
+template<typename T>
+SimdKernels<T> select_simd_kernels()
+{
+#ifdef TENSOR_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return {binary_avx512<T>, binary_scalar_avx512<T>, sum_avx512<T>, sum_squares_avx512<T>, "avx512"};
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return {binary_avx2<T>, binary_scalar_avx2<T>, sum_avx2<T>, sum_squares_avx2<T>, "avx2"};
+#endif
+#ifdef TENSOR_SIMD_VECTOR_EXT
+    return {binary_base<T>, binary_scalar_base<T>, sum_base<T>, sum_squares_base<T>, "sse"};
+#else
+    return {binary_base<T>, binary_scalar_base<T>, sum_base<T>, sum_squares_base<T>, "scalar"};
+#endif
+}
+
+template<typename T>
+const SimdKernels<T>& simd()
+{
+    static_assert(is_simd_type<T>::value, "SIMD kernels exist for float and double only");
+    static const SimdKernels<T> kernels = select_simd_kernels<T>();
+    return kernels;
+}
+
+} // namespace tensor_kernels
+
+#endif // TENSEURS_KERNELS_H_INCLUDED
@@ -0,0 +1,369 @@
+///  -------------------------------------------------
+///  Thread pool used by Tenseurs.h
+///  StandAlone, header only
+///  Coded by JP CHAMPEAUX
+///  contact : JPC@irsamc.upse-tlse.fr
+///  Free of use for Academic purpose only !
+///  (please, just mention author in your works if used or if your own code is inspired from it)
+///  --------------------------------------------------
+
+
+#ifndef TENSEURS_PARALLEL_H_INCLUDED
+#define TENSEURS_PARALLEL_H_INCLUDED
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <type_traits>
+
+// Pool de threads à vol de travail. Nombre de threads : TENSOR_NUM_THREADS (variable
+// d'environnement), sinon le nombre de coeurs ; modifiable par tensor_kernels::set_num_threads.
+// -DTENSOR_NO_THREADS compile tout en séquentiel.
+#ifndef TENSOR_NO_THREADS
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <exception>
+#endif
+
+namespace tensor_kernels
+{
+
+// En dessous de ce nombre d'éléments par tâche, le découpage coûte plus qu'il ne rapporte
+constexpr size_t PARALLEL_GRAIN = 32768;
+
+#ifndef TENSOR_NO_THREADS
+
+/// Pool de threads à vol de travail.
+/// run(n, f) exécute f(0) ... f(n-1) : chaque participant (le thread appelant compris)
+/// reçoit une plage contiguë de tâches qu'il consomme par l'avant ; un participant
+/// inoccupé vole la moitié arrière de la plage d'un autre.
+/// Un appel imbriqué (depuis une tâche) ou concurrent s'exécute en séquentiel.
+class ThreadPool
+{
+    // Plage de tâches [lo, hi) d'un participant
+    struct Slot
+    {
+        std::mutex lock;
+        size_t lo = 0;
+        size_t hi = 0;
+    };
+
+public:
+    explicit ThreadPool(size_t n_threads)
+        : slots(std::max<size_t>(n_threads, 1))
+    {
+        for (size_t w = 1; w < slots.size(); ++w)
+            workers.emplace_back([this, w] { worker_loop(w); });
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> guard(state_lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& t : workers)
+            t.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Nombre de participants, thread appelant compris
+    size_t size() const
+    {
+        return slots.size();
+    }
+
+    template<typename F>
+    void run(size_t n_tasks, F&& f)
+    {
+        if (n_tasks == 0)
+            return;
+
+        std::unique_lock<std::mutex> busy(run_lock, std::try_to_lock);
+        if (n_tasks == 1 || slots.size() == 1 || in_task() || !busy.owns_lock())
+        {
+            for (size_t t = 0; t < n_tasks; ++t)
+                f(t);
+            return;
+        }
+
+        // Répartition initiale en plages égales
+        size_t n_slots = slots.size();
+        for (size_t s = 0; s < n_slots; ++s)
+        {
+            std::lock_guard<std::mutex> guard(slots[s].lock);
+            slots[s].lo = n_tasks * s / n_slots;
+            slots[s].hi = n_tasks * (s + 1) / n_slots;
+        }
+
+        task_fn = &invoke<typename std::remove_reference<F>::type>;
+        task_ctx = const_cast<void*>(static_cast<const void*>(&f));
+        error = nullptr;
+        {
+            std::lock_guard<std::mutex> guard(state_lock);
+            active = n_slots - 1;
+            ++generation;
+        }
+        wake.notify_all();
+
+        participate(0);
+
+        // Les workers lisent task_fn / task_ctx jusqu'à leur sortie : on les attend tous
+        std::unique_lock<std::mutex> guard(state_lock);
+        done.wait(guard, [this] { return active == 0; });
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+private:
+    template<typename F>
+    static void invoke(void* ctx, size_t t)
+    {
+        (*static_cast<F*>(ctx))(t);
+    }
+
+    static bool& in_task()
+    {
+        static thread_local bool flag = false;
+        return flag;
+    }
+
+    // Prochaine tâche de sa propre plage, sinon vol de la moitié d'une autre plage
+    bool next_task(size_t self, size_t& t)
+    {
+        Slot& mine = slots[self];
+        {
+            std::lock_guard<std::mutex> guard(mine.lock);
+            if (mine.lo < mine.hi)
+            {
+                t = mine.lo++;
+                return true;
+            }
+        }
+
+        size_t n_slots = slots.size();
+        for (size_t k = 1; k < n_slots; ++k)
+        {
+            Slot& victim = slots[(self + k) % n_slots];
+            size_t lo, hi;
+            {
+                std::lock_guard<std::mutex> guard(victim.lock);
+                size_t left = victim.hi - victim.lo;
+                if (left == 0)
+                    continue;
+                hi = victim.hi;
+                lo = victim.hi - (left + 1) / 2;
+                victim.hi = lo;
+            }
+            std::lock_guard<std::mutex> guard(mine.lock);
+            mine.lo = lo + 1;
+            mine.hi = hi;
+            t = lo;
+            return true;
+        }
+        return false;
+    }
+
+    void participate(size_t self)
+    {
+        in_task() = true;
+        size_t t;
+        while (next_task(self, t))
+        {
+            try
+            {
+                task_fn(task_ctx, t);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> guard(state_lock);
+                if (!error)
+                    error = std::current_exception();
+            }
+        }
+        in_task() = false;
+    }
+
+    void worker_loop(size_t self)
+    {
+        size_t seen = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> guard(state_lock);
+                wake.wait(guard, [&] { return stopping || generation != seen; });
+                if (stopping)
+                    return;
+                seen = generation;
+            }
+
+            participate(self);
+
+            std::lock_guard<std::mutex> guard(state_lock);
+            if (--active == 0)
+                done.notify_one();
+        }
+    }
+
+    std::vector<Slot> slots;
+    std::vector<std::thread> workers;
+
+    std::mutex run_lock;
+    std::mutex state_lock;
+    std::condition_variable wake;
+    std::condition_variable done;
+    size_t generation = 0;
+    size_t active = 0;
+    bool stopping = false;
+
+    void (*task_fn)(void*, size_t) = nullptr;
+    void* task_ctx = nullptr;
+    std::exception_ptr error;
+};
+
+inline size_t default_num_threads()
+{
+    if (const char* env = std::getenv("TENSOR_NUM_THREADS"))
+    {
+        long n = std::strtol(env, nullptr, 10);
+        if (n > 0)
+            return static_cast<size_t>(n);
+    }
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw ? hw : 1;
+}
+
+inline std::mutex& thread_pool_lock()
+{
+    static std::mutex lock;
+    return lock;
+}
+
+inline std::unique_ptr<ThreadPool>& thread_pool_instance()
+{
+    static std::unique_ptr<ThreadPool> pool;
+    return pool;
+}
+
+// Copie de thread_pool_instance().get() lue sans verrou
+inline std::atomic<ThreadPool*>& thread_pool_cache()
+{
+    static std::atomic<ThreadPool*> cache{nullptr};
+    return cache;
+}
+
+/// Pool partagé, créé au premier usage ; le verrou n'est pris qu'à la création
+inline ThreadPool& thread_pool()
+{
+    if (ThreadPool* cached = thread_pool_cache().load(std::memory_order_acquire))
+        return *cached;
+
+    std::lock_guard<std::mutex> guard(thread_pool_lock());
+    std::unique_ptr<ThreadPool>& pool = thread_pool_instance();
+    if (!pool)
+    {
+        pool.reset(new ThreadPool(default_num_threads()));
+        thread_pool_cache().store(pool.get(), std::memory_order_release);
+    }
+    return *pool;
+}
+
+/// Change le nombre de threads (0 : valeur par défaut). Ne pas appeler pendant un calcul.
+inline void set_num_threads(size_t n)
+{
+    std::lock_guard<std::mutex> guard(thread_pool_lock());
+    std::unique_ptr<ThreadPool>& pool = thread_pool_instance();
+    thread_pool_cache().store(nullptr, std::memory_order_release);
+    pool.reset(new ThreadPool(n ? n : default_num_threads()));
+    thread_pool_cache().store(pool.get(), std::memory_order_release);
+}
+
+inline size_t num_threads()
+{
+    return thread_pool().size();
+}
+
+template<typename F>
+void run_tasks(size_t n_tasks, F&& f)
+{
+    thread_pool().run(n_tasks, f);
+}
+
+#else
+
+inline void set_num_threads(size_t)
+{
+}
+
+inline size_t num_threads()
+{
+    return 1;
+}
+
+template<typename F>
+void run_tasks(size_t n_tasks, F&& f)
+{
+    for (size_t t = 0; t < n_tasks; ++t)
+        f(t);
+}
+
+#endif // TENSOR_NO_THREADS
+
+/// f(lo, hi) sur des morceaux de [begin, end) d'au moins grain éléments.
+/// Une seule plage (donc aucun thread) si l'intervalle tient dans grain.
+template<typename F>
+void parallel_for(size_t begin, size_t end, size_t grain, F&& f)
+{
+    if (end <= begin)
+        return;
+    size_t n = end - begin;
+    grain = std::max<size_t>(grain, 1);
+    // Comparaison au grain d'abord : un petit intervalle ne consulte pas le pool
+    size_t threads = (n <= grain) ? 1 : num_threads();
+    if (threads == 1)
+    {
+        f(begin, end);
+        return;
+    }
+
+    // Quelques morceaux par thread pour que le vol de travail équilibre la charge
+    size_t n_chunks = std::min((n + grain - 1) / grain, threads * 8);
+    run_tasks(n_chunks, [&](size_t c)
+    {
+        f(begin + n * c / n_chunks, begin + n * (c + 1) / n_chunks);
+    });
+}
+
+/// Réduction par morceaux fixes de grain éléments, combinés dans l'ordre :
+/// le résultat ne dépend pas du nombre de threads.
+template<typename T, typename Map, typename Combine>
+T parallel_reduce(size_t n, size_t grain, T init, Map&& map, Combine&& combine)
+{
+    grain = std::max<size_t>(grain, 1);
+    size_t n_chunks = (n + grain - 1) / grain;
+    if (n_chunks <= 1)
+        return n ? combine(init, map(size_t(0), n)) : init;
+
+    std::vector<T> partial(n_chunks, init);
+    parallel_for(0, n_chunks, 1, [&](size_t c0, size_t c1)
+    {
+        for (size_t c = c0; c < c1; ++c)
+            partial[c] = map(c * grain, std::min(n, (c + 1) * grain));
+    });
+
+    T acc = init;
+    for (const T& p : partial)
+        acc = combine(acc, p);
+    return acc;
+}
+
+} // namespace tensor_kernels
+
+#endif // TENSEURS_PARALLEL_H_INCLUDED
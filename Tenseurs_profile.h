@@ -0,0 +1,371 @@
+///  -------------------------------------------------
+///  Profilage des opérations de Tensor (opt-in)
+///  StandAlone class, header only
+///  Coded by JP CHAMPEAUX
+///  contact : JPC@irsamc.upse-tlse.fr
+///  Free of use for Academic purpose only !
+///  (please, just mention author in your works if used or if your own code is inspired from it)
+///  --------------------------------------------------
+
+
+#ifndef TENSEURS_PROFILE_H_INCLUDED
+#define TENSEURS_PROFILE_H_INCLUDED
+
+/// Instrumentation des opérations : -DTENSOR_PROFILE=1.
+/// Sans ce drapeau, les macros TENSOR_PROFILE_* ne génèrent aucun code.
+/// Par opération et par forme : appels, temps (total et propre), octets alloués, octets copiés, FLOP.
+///     tensor_profile::report(cout);
+///     tensor_profile::write_chrome_trace("trace.json");   // chrome://tracing, Perfetto
+/// Variables d'environnement, lues à la sortie du programme :
+///     TENSOR_PROFILE_REPORT=1   rapport sur stderr
+///     TENSOR_PROFILE_TRACE=f    trace Chrome dans le fichier f
+#ifndef TENSOR_PROFILE
+#define TENSOR_PROFILE 0
+#endif
+
+#if TENSOR_PROFILE
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tensor_profile
+{
+
+using Clock = std::chrono::steady_clock;
+
+struct OpStats
+{
+    size_t calls = 0;
+    double seconds = 0;        // inclusif (opérations imbriquées comprises)
+    double self_seconds = 0;   // hors opérations imbriquées
+    size_t bytes_allocated = 0;
+    size_t bytes_copied = 0;
+    double flops = 0;
+};
+
+struct TraceEvent
+{
+    const char* name;
+    std::vector<size_t> shape;
+    int64_t start_ns;
+    int64_t duration_ns;
+    unsigned thread;
+    size_t bytes_allocated;
+    size_t bytes_copied;
+    double flops;
+};
+
+inline std::string shape_string(const std::vector<size_t>& shape)
+{
+    std::ostringstream os;
+    for (size_t i = 0; i < shape.size(); ++i)
+        os << (i ? "x" : "") << shape[i];
+    return shape.empty() ? std::string("-") : os.str();
+}
+
+// Petit identifiant stable par thread (0 pour le premier thread qui enregistre)
+inline unsigned thread_index()
+{
+    static std::atomic<unsigned> next{0};
+    thread_local unsigned index = next++;
+    return index;
+}
+
+class Profiler
+{
+    using Key = std::pair<std::string, std::vector<size_t>>;
+
+    std::mutex lock;
+    std::map<Key, OpStats> stats;
+    OpStats outside;                // allocations et copies hors de toute opération
+    std::vector<TraceEvent> events;
+    size_t trace_capacity = size_t(1) << 20;
+    size_t dropped = 0;
+    std::atomic<bool> enabled{true};   // lu par les threads du pool
+    Clock::time_point origin = Clock::now();
+
+    Profiler() = default;
+
+    // Appelé à la sortie du programme : une erreur est signalée, pas propagée (destructeur noexcept)
+    ~Profiler()
+    {
+        try
+        {
+            if (const char* r = std::getenv("TENSOR_PROFILE_REPORT"))
+                if (*r && *r != '0')
+                    report(std::cerr);
+            if (const char* path = std::getenv("TENSOR_PROFILE_TRACE"))
+                if (*path)
+                    write_chrome_trace(path);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "tensor_profile: " << e.what() << std::endl;
+        }
+    }
+
+public:
+    static Profiler& instance()
+    {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    bool is_enabled() const
+    {
+        return enabled;
+    }
+
+    void set_enabled(bool on)
+    {
+        enabled = on;
+    }
+
+    void set_trace_capacity(size_t n)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        trace_capacity = n;
+    }
+
+    int64_t now_ns() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - origin).count();
+    }
+
+    void record(const char* name, const std::vector<size_t>& shape, int64_t start_ns, int64_t duration_ns,
+                int64_t children_ns, size_t allocated, size_t copied, double flops)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        OpStats& s = stats[Key(name, shape)];
+        ++s.calls;
+        s.seconds += duration_ns * 1e-9;
+        s.self_seconds += (duration_ns - children_ns) * 1e-9;
+        s.bytes_allocated += allocated;
+        s.bytes_copied += copied;
+        s.flops += flops;
+
+        if (events.size() < trace_capacity)
+            events.push_back(TraceEvent{name, shape, start_ns, duration_ns, thread_index(), allocated, copied, flops});
+        else
+            ++dropped;
+    }
+
+    void record_outside(size_t allocated, size_t copied)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        outside.bytes_allocated += allocated;
+        outside.bytes_copied += copied;
+    }
+
+    void reset()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stats.clear();
+        outside = OpStats();
+        events.clear();
+        dropped = 0;
+        origin = Clock::now();
+    }
+
+    /// Tableau trié par temps propre décroissant
+    void report(std::ostream& os)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        std::vector<std::pair<Key, OpStats>> rows(stats.begin(), stats.end());
+        std::sort(rows.begin(), rows.end(), [](const std::pair<Key, OpStats>& a, const std::pair<Key, OpStats>& b)
+        {
+            return a.second.self_seconds > b.second.self_seconds;
+        });
+
+        std::ios_base::fmtflags flags = os.flags();
+        std::streamsize precision = os.precision();
+        os << std::left << std::setw(24) << "operation" << std::setw(18) << "shape" << std::right
+           << std::setw(10) << "calls" << std::setw(12) << "total ms" << std::setw(12) << "self ms"
+           << std::setw(12) << "avg us" << std::setw(12) << "alloc MB" << std::setw(12) << "copy MB"
+           << std::setw(10) << "GFLOP" << std::setw(10) << "GFLOP/s" << "\n";
+
+        OpStats total;
+        os << std::fixed;
+        for (const auto& row : rows)
+        {
+            const OpStats& s = row.second;
+            os << std::left << std::setw(24) << row.first.first << std::setw(18) << shape_string(row.first.second) << std::right
+               << std::setw(10) << s.calls
+               << std::setprecision(3) << std::setw(12) << s.seconds * 1e3 << std::setw(12) << s.self_seconds * 1e3
+               << std::setw(12) << s.seconds * 1e6 / s.calls
+               << std::setw(12) << s.bytes_allocated / 1e6 << std::setw(12) << s.bytes_copied / 1e6
+               << std::setw(10) << s.flops * 1e-9
+               << std::setw(10) << (s.self_seconds > 0 ? s.flops * 1e-9 / s.self_seconds : 0.0) << "\n";
+            total.calls += s.calls;
+            total.self_seconds += s.self_seconds;
+            total.bytes_allocated += s.bytes_allocated;
+            total.bytes_copied += s.bytes_copied;
+            total.flops += s.flops;
+        }
+        os << std::left << std::setw(42) << "total" << std::right << std::setw(10) << total.calls
+           << std::setw(12) << "" << std::setw(12) << total.self_seconds * 1e3 << std::setw(12) << ""
+           << std::setw(12) << total.bytes_allocated / 1e6 << std::setw(12) << total.bytes_copied / 1e6
+           << std::setw(10) << total.flops * 1e-9 << "\n";
+        if (outside.bytes_allocated || outside.bytes_copied)
+            os << std::left << std::setw(42) << "outside operations" << std::right << std::setw(10) << "" << std::setw(36) << ""
+               << std::setw(12) << outside.bytes_allocated / 1e6 << std::setw(12) << outside.bytes_copied / 1e6 << "\n";
+        if (dropped)
+            os << dropped << " trace events dropped (trace capacity " << trace_capacity << ")\n";
+        os.flags(flags);
+        os.precision(precision);
+    }
+
+    /// Format Trace Event de Chrome : un événement complet ("ph": "X") par appel
+    void write_chrome_trace(const std::string& path)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        std::ofstream os(path);
+        if (!os)
+            throw std::runtime_error("Cannot open trace file: " + path);
+
+        os << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+        for (size_t i = 0; i < events.size(); ++i)
+        {
+            const TraceEvent& e = events[i];
+            os << "{\"name\": \"" << e.name << "\", \"cat\": \"tensor\", \"ph\": \"X\""
+               << ", \"ts\": " << e.start_ns / 1000 << "." << std::setw(3) << std::setfill('0') << e.start_ns % 1000
+               << ", \"dur\": " << e.duration_ns / 1000 << "." << std::setw(3) << e.duration_ns % 1000 << std::setfill(' ')
+               << ", \"pid\": 1, \"tid\": " << e.thread
+               << ", \"args\": {\"shape\": \"" << shape_string(e.shape) << "\""
+               << ", \"bytes_allocated\": " << e.bytes_allocated
+               << ", \"bytes_copied\": " << e.bytes_copied
+               << ", \"flops\": " << e.flops << "}}"
+               << (i + 1 < events.size() ? ",\n" : "\n");
+        }
+        os << "]}\n";
+    }
+};
+
+/// Une opération en cours : mesure à la destruction. Les allocations et copies faites
+/// pendant l'opération, sur le même thread, lui sont attribuées (à la plus interne).
+class ScopedOp
+{
+    const char* name;
+    std::vector<size_t> shape;
+    int64_t start_ns = 0;
+    int64_t children_ns = 0;
+    size_t allocated = 0;
+    size_t copied = 0;
+    double flops = 0;
+    ScopedOp* parent;
+    bool active;
+
+public:
+    // Opération la plus interne du thread appelant
+    static ScopedOp*& current()
+    {
+        thread_local ScopedOp* op = nullptr;
+        return op;
+    }
+
+    ScopedOp(const char* name_, const std::vector<size_t>& shape_)
+        : name(name_), parent(current()), active(Profiler::instance().is_enabled())
+    {
+        if (!active)
+            return;
+        shape = shape_;
+        current() = this;
+        start_ns = Profiler::instance().now_ns();
+    }
+
+    ScopedOp(const ScopedOp&) = delete;
+    ScopedOp& operator=(const ScopedOp&) = delete;
+
+    ~ScopedOp()
+    {
+        if (!active)
+            return;
+        int64_t duration = Profiler::instance().now_ns() - start_ns;
+        current() = parent;
+        if (parent)
+            parent->children_ns += duration;
+        Profiler::instance().record(name, shape, start_ns, duration, children_ns, allocated, copied, flops);
+    }
+
+    void add_flops(double n)
+    {
+        flops += n;
+    }
+
+    void add_allocated(size_t bytes)
+    {
+        allocated += bytes;
+    }
+
+    void add_copied(size_t bytes)
+    {
+        copied += bytes;
+    }
+};
+
+inline void record_alloc(size_t bytes)
+{
+    if (ScopedOp* op = ScopedOp::current())
+        op->add_allocated(bytes);
+    else if (Profiler::instance().is_enabled())
+        Profiler::instance().record_outside(bytes, 0);
+}
+
+inline void record_copy(size_t bytes)
+{
+    if (ScopedOp* op = ScopedOp::current())
+        op->add_copied(bytes);
+    else if (Profiler::instance().is_enabled())
+        Profiler::instance().record_outside(0, bytes);
+}
+
+inline void report(std::ostream& os)
+{
+    Profiler::instance().report(os);
+}
+
+inline void write_chrome_trace(const std::string& path)
+{
+    Profiler::instance().write_chrome_trace(path);
+}
+
+inline void reset()
+{
+    Profiler::instance().reset();
+}
+
+inline void set_enabled(bool on)
+{
+    Profiler::instance().set_enabled(on);
+}
+
+} // namespace tensor_profile
+
+#define TENSOR_PROFILE_OP(name, shape) tensor_profile::ScopedOp tensor_profile_op_(name, shape)
+#define TENSOR_PROFILE_FLOPS(n) tensor_profile_op_.add_flops(static_cast<double>(n))
+#define TENSOR_PROFILE_ALLOC(bytes) tensor_profile::record_alloc(bytes)
+#define TENSOR_PROFILE_COPY(bytes) tensor_profile::record_copy(bytes)
+
+#else
+
+#define TENSOR_PROFILE_OP(name, shape) ((void)0)
+#define TENSOR_PROFILE_FLOPS(n) ((void)0)
+#define TENSOR_PROFILE_ALLOC(bytes) ((void)0)
+#define TENSOR_PROFILE_COPY(bytes) ((void)0)
+
+#endif // TENSOR_PROFILE
+
+#endif // TENSEURS_PROFILE_H_INCLUDED
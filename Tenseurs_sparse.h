@@ -0,0 +1,713 @@
+///  -------------------------------------------------
+///  SparseTensor : tenseur creux (construction COO, stockage CSF)
+///  StandAlone class, header only
+///  Coded by JP CHAMPEAUX
+///  contact : JPC@irsamc.upse-tlse.fr
+///  Free of use for Academic purpose only !
+///  (please, just mention author in your works if used or if your own code is inspired from it)
+///  CLASS SparseTensor
+///  --------------------------------------------------
+
+
+#ifndef TENSEURS_SPARSE_H_INCLUDED
+#define TENSEURS_SPARSE_H_INCLUDED
+
+#include <algorithm>
+#include <numeric>
+
+#include "Tenseurs.h"
+
+template<typename T>
+class SparseTensor;
+
+/// Construction par coordonnées (COO) : coo.insert({i, j, k}, v);
+/// Les doublons sont additionnés lors de la compression en SparseTensor.
+template<typename T>
+class CooTensor
+{
+    friend class SparseTensor<T>;
+
+private:
+    vector<size_t> shape;
+    vector<size_t> coords;  // nnz x rank, à la suite
+    vector<T> values;
+
+public:
+    explicit CooTensor(const vector<size_t>& shape_)
+        : shape(shape_)
+    {
+    }
+
+    void insert(const vector<size_t>& indices, const T& value)
+    {
+        if (indices.size() != shape.size())
+            throw runtime_error("Index dimension mismatch");
+        for (size_t d = 0; d < shape.size(); ++d)
+            if (indices[d] >= shape[d])
+                throw out_of_range("Index out of bounds");
+        coords.insert(coords.end(), indices.begin(), indices.end());
+        values.push_back(value);
+    }
+
+    void reserve(size_t n)
+    {
+        coords.reserve(n * shape.size());
+        values.reserve(n);
+    }
+
+    // Entrées insérées (doublons compris)
+    size_t nnz() const
+    {
+        return values.size();
+    }
+
+    const vector<size_t>& get_shape() const
+    {
+        return shape;
+    }
+};
+
+/// Tenseur creux en stockage CSF (compressed sparse fiber) : un arbre dont le niveau l
+/// porte les indices distincts de l'axe l sous chaque préfixe (i0, ..., i(l-1)).
+/// Seuls les éléments non nuls sont stockés et parcourus ; l'ordre des feuilles est row-major.
+/// Immuable : les modifications passent par CooTensor ou par les opérations.
+template<typename T>
+class SparseTensor
+{
+private:
+    vector<size_t> shape;
+    vector<vector<size_t>> ids;  // ids[l][n] : indice sur l'axe l du noeud n
+    vector<vector<size_t>> ptr;  // enfants du noeud n du niveau l : [ptr[l][n], ptr[l][n + 1]) (l < rank - 1)
+    vector<T> values;            // une valeur par feuille
+
+    static bool is_zero(const T& v)
+    {
+        if constexpr (std::is_arithmetic<T>::value)
+            return v == T(0);
+        else
+            return false;
+    }
+
+    static bool less(const size_t* a, const size_t* b, size_t rank)
+    {
+        return std::lexicographical_compare(a, a + rank, b, b + rank);
+    }
+
+    static bool equal(const size_t* a, const size_t* b, size_t rank)
+    {
+        return std::equal(a, a + rank, b);
+    }
+
+    /// Arbre CSF depuis des entrées triées (row-major) et distinctes
+    void build(const vector<size_t>& coords, vector<T> vals)
+    {
+        size_t rank = shape.size();
+        size_t n = vals.size();
+        ids.assign(rank, vector<size_t>());
+        ptr.assign(rank ? rank - 1 : 0, vector<size_t>());
+
+        for (size_t e = 0; e < n; ++e)
+        {
+            const size_t* c = coords.data() + e * rank;
+            // Premier niveau où l'entrée quitte le chemin de la précédente
+            size_t l = 0;
+            if (e > 0)
+            {
+                const size_t* p = c - rank;
+                while (l < rank && c[l] == p[l])
+                    ++l;
+            }
+            for (; l < rank; ++l)
+            {
+                if (l + 1 < rank)
+                    ptr[l].push_back(ids[l + 1].size());
+                ids[l].push_back(c[l]);
+            }
+        }
+        for (size_t l = 0; l + 1 < rank; ++l)
+            ptr[l].push_back(ids[l + 1].size());
+        values = std::move(vals);
+    }
+
+    /// Trie des entrées COO, additionne les doublons et écarte les zéros
+    void build_unsorted(const vector<size_t>& coords, const vector<T>& vals)
+    {
+        size_t rank = shape.size();
+        vector<size_t> order(vals.size());
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+        {
+            return less(coords.data() + a * rank, coords.data() + b * rank, rank);
+        });
+
+        vector<size_t> sorted_coords;
+        vector<T> sorted_vals;
+        sorted_coords.reserve(coords.size());
+        sorted_vals.reserve(vals.size());
+        for (size_t k = 0; k < order.size();)
+        {
+            const size_t* c = coords.data() + order[k] * rank;
+            T sum = vals[order[k]];
+            size_t next = k + 1;
+            for (; next < order.size() && equal(coords.data() + order[next] * rank, c, rank); ++next)
+                sum = sum + vals[order[next]];
+            if (!is_zero(sum))
+            {
+                sorted_coords.insert(sorted_coords.end(), c, c + rank);
+                sorted_vals.push_back(sum);
+            }
+            k = next;
+        }
+        build(sorted_coords, std::move(sorted_vals));
+    }
+
+    // Parcours en profondeur du sous-arbre [lo, hi) du niveau l
+    template<typename F>
+    void visit(size_t l, size_t lo, size_t hi, vector<size_t>& indices, F& f) const
+    {
+        for (size_t n = lo; n < hi; ++n)
+        {
+            indices[l] = ids[l][n];
+            if (l + 1 == shape.size())
+                f(static_cast<const vector<size_t>&>(indices), values[n]);
+            else
+                visit(l + 1, ptr[l][n], ptr[l][n + 1], indices, f);
+        }
+    }
+
+    /// Entrées à plat (coordonnées nnz x rank, valeurs), en ordre row-major
+    void entries(vector<size_t>& coords, vector<T>& vals) const
+    {
+        coords.clear();
+        coords.reserve(values.size() * shape.size());
+        vals.assign(values.begin(), values.end());
+        for_each([&](const vector<size_t>& idx, const T&)
+        {
+            coords.insert(coords.end(), idx.begin(), idx.end());
+        });
+    }
+
+    void check_same_shape(const vector<size_t>& other_shape) const
+    {
+        if (shape != other_shape)
+            throw runtime_error("Shape mismatch");
+    }
+
+    /// Fusion de deux listes triées : op(a, b) sur l'union (absent = 0) ou l'intersection
+    template<typename Op>
+    static SparseTensor merge(const SparseTensor& A, const SparseTensor& B, Op op, bool intersection)
+    {
+        A.check_same_shape(B.shape);
+        size_t rank = A.shape.size();
+        vector<size_t> ca, cb, coords;
+        vector<T> va, vb, vals;
+        A.entries(ca, va);
+        B.entries(cb, vb);
+
+        size_t i = 0, j = 0;
+        auto push = [&](const size_t* c, const T& v)
+        {
+            if (is_zero(v))
+                return;
+            coords.insert(coords.end(), c, c + rank);
+            vals.push_back(v);
+        };
+        while (i < va.size() || j < vb.size())
+        {
+            const size_t* a = ca.data() + i * rank;
+            const size_t* b = cb.data() + j * rank;
+            if (j == vb.size() || (i < va.size() && less(a, b, rank)))
+            {
+                if (!intersection)
+                    push(a, op(va[i], T(0)));
+                ++i;
+            }
+            else if (i == va.size() || less(b, a, rank))
+            {
+                if (!intersection)
+                    push(b, op(T(0), vb[j]));
+                ++j;
+            }
+            else
+            {
+                push(a, op(va[i], vb[j]));
+                ++i;
+                ++j;
+            }
+        }
+
+        SparseTensor result(A.shape);
+        result.build(coords, std::move(vals));
+        return result;
+    }
+
+    template<typename Op>
+    SparseTensor map_values(Op op) const
+    {
+        SparseTensor result(*this);
+        for (T& v : result.values)
+            v = op(v);
+        return result;
+    }
+
+    // Indice row-major dans une forme donnée
+    static size_t linear(const size_t* idx, const vector<size_t>& s)
+    {
+        size_t off = 0;
+        for (size_t d = 0; d < s.size(); ++d)
+            off = off * s[d] + idx[d];
+        return off;
+    }
+
+public:
+    SparseTensor() = default;
+
+    // Tenseur nul de forme donnée
+    explicit SparseTensor(const vector<size_t>& shape_)
+        : shape(shape_)
+    {
+        build({}, {});
+    }
+
+    SparseTensor(const CooTensor<T>& coo)
+        : shape(coo.shape)
+    {
+        build_unsorted(coo.coords, coo.values);
+    }
+
+    // Éléments non nuls d'un tenseur dense
+    explicit SparseTensor(const Tensor<T>& dense)
+        : shape(dense.get_shape())
+    {
+        size_t rank = shape.size();
+        vector<size_t> coords, idx(rank, 0);
+        vector<T> vals;
+        const T* data = dense.data();
+        for (size_t i = 0, n = dense.size(); i < n; ++i)
+        {
+            if (!is_zero(data[i]))
+            {
+                coords.insert(coords.end(), idx.begin(), idx.end());
+                vals.push_back(data[i]);
+            }
+            // Indice row-major suivant
+            for (size_t d = rank; d-- > 0;)
+            {
+                if (++idx[d] < shape[d])
+                    break;
+                idx[d] = 0;
+            }
+        }
+        build(coords, std::move(vals));
+    }
+
+    Tensor<T> to_tensor() const
+    {
+        Tensor<T> result(shape, T(0));
+        T* out = result.data();
+        for_each([&](const vector<size_t>& idx, const T& v)
+        {
+            out[linear(idx.data(), shape)] = v;
+        });
+        return result;
+    }
+
+    const vector<size_t>& get_shape() const
+    {
+        return shape;
+    }
+
+    size_t ndim() const
+    {
+        return shape.size();
+    }
+
+    // Nombre d'éléments de la forme dense
+    size_t size() const
+    {
+        return std::accumulate(shape.begin(), shape.end(), size_t(1), std::multiplies<size_t>());
+    }
+
+    // Nombre d'éléments stockés
+    size_t nnz() const
+    {
+        return values.size();
+    }
+
+    double density() const
+    {
+        return size() ? double(nnz()) / double(size()) : 0.0;
+    }
+
+    /// f(indices, valeur) sur chaque élément stocké, en ordre row-major
+    template<typename F>
+    void for_each(F f) const
+    {
+        if (shape.empty())
+        {
+            if (!values.empty())
+                f(vector<size_t>(), values[0]);
+            return;
+        }
+        vector<size_t> indices(shape.size());
+        visit(0, 0, ids[0].size(), indices, f);
+    }
+
+    /// Lecture (T(0) si l'élément n'est pas stocké) : recherche dichotomique à chaque niveau
+    T at(const vector<size_t>& indices) const
+    {
+        if (indices.size() != shape.size())
+            throw runtime_error("Index dimension mismatch");
+        if (shape.empty())
+            return values.empty() ? T(0) : values[0];
+
+        size_t lo = 0, hi = ids[0].size();
+        for (size_t l = 0; l < shape.size(); ++l)
+        {
+            if (indices[l] >= shape[l])
+                throw out_of_range("Index out of bounds");
+            auto first = ids[l].begin() + lo, last = ids[l].begin() + hi;
+            auto it = std::lower_bound(first, last, indices[l]);
+            if (it == last || *it != indices[l])
+                return T(0);
+            size_t n = it - ids[l].begin();
+            if (l + 1 == shape.size())
+                return values[n];
+            lo = ptr[l][n];
+            hi = ptr[l][n + 1];
+        }
+        return T(0);
+    }
+
+    template<typename... Args>
+    T operator()(Args... args) const
+    {
+        return at(vector<size_t>{static_cast<size_t>(args)...});
+    }
+
+    /// Élément par élément (mêmes formes, sans diffusion)
+    friend SparseTensor operator+(const SparseTensor& a, const SparseTensor& b)
+    {
+        return merge(a, b, [](const T& x, const T& y) { return x + y; }, false);
+    }
+
+    friend SparseTensor operator-(const SparseTensor& a, const SparseTensor& b)
+    {
+        return merge(a, b, [](const T& x, const T& y) { return x - y; }, false);
+    }
+
+    // Hadamard : seule l'intersection des éléments stockés est calculée
+    friend SparseTensor operator*(const SparseTensor& a, const SparseTensor& b)
+    {
+        return merge(a, b, [](const T& x, const T& y) { return x * y; }, true);
+    }
+
+    friend SparseTensor operator*(const SparseTensor& a, const T& s)
+    {
+        return a.map_values([&](const T& v) { return v * s; });
+    }
+
+    friend SparseTensor operator*(const T& s, const SparseTensor& a)
+    {
+        return a.map_values([&](const T& v) { return s * v; });
+    }
+
+    friend SparseTensor operator/(const SparseTensor& a, const T& s)
+    {
+        return a.map_values([&](const T& v) { return v / s; });
+    }
+
+    friend SparseTensor operator-(const SparseTensor& a)
+    {
+        return a.map_values([](const T& v) { return -v; });
+    }
+
+    // Avec un tenseur dense : somme dense, produit de Hadamard creux
+    friend Tensor<T> operator+(const SparseTensor& a, const Tensor<T>& b)
+    {
+        a.check_same_shape(b.get_shape());
+        Tensor<T> result = b;
+        T* out = result.data();
+        a.for_each([&](const vector<size_t>& idx, const T& v)
+        {
+            size_t i = linear(idx.data(), a.shape);
+            out[i] = v + out[i];
+        });
+        return result;
+    }
+
+    friend Tensor<T> operator+(const Tensor<T>& a, const SparseTensor& b)
+    {
+        b.check_same_shape(a.get_shape());
+        Tensor<T> result = a;
+        T* out = result.data();
+        b.for_each([&](const vector<size_t>& idx, const T& v)
+        {
+            size_t i = linear(idx.data(), b.shape);
+            out[i] = out[i] + v;
+        });
+        return result;
+    }
+
+    friend Tensor<T> operator-(const SparseTensor& a, const Tensor<T>& b)
+    {
+        return a + Tensor<T>(b * T(-1));
+    }
+
+    friend Tensor<T> operator-(const Tensor<T>& a, const SparseTensor& b)
+    {
+        return a + (-b);
+    }
+
+    friend SparseTensor operator*(const SparseTensor& a, const Tensor<T>& b)
+    {
+        a.check_same_shape(b.get_shape());
+        const T* in = b.data();
+        SparseTensor result(a);
+        size_t k = 0;
+        a.for_each([&](const vector<size_t>& idx, const T& v)
+        {
+            result.values[k++] = v * in[linear(idx.data(), a.shape)];
+        });
+        return result.pruned();
+    }
+
+    friend SparseTensor operator*(const Tensor<T>& a, const SparseTensor& b)
+    {
+        b.check_same_shape(a.get_shape());
+        const T* in = a.data();
+        SparseTensor result(b);
+        size_t k = 0;
+        b.for_each([&](const vector<size_t>& idx, const T& v)
+        {
+            result.values[k++] = in[linear(idx.data(), b.shape)] * v;
+        });
+        return result.pruned();
+    }
+
+    // Sans les éléments devenus nuls
+    SparseTensor pruned() const
+    {
+        vector<size_t> coords, kept_coords;
+        vector<T> vals, kept_vals;
+        entries(coords, vals);
+        size_t rank = shape.size();
+        for (size_t e = 0; e < vals.size(); ++e)
+        {
+            if (is_zero(vals[e]))
+                continue;
+            kept_coords.insert(kept_coords.end(), coords.begin() + e * rank, coords.begin() + (e + 1) * rank);
+            kept_vals.push_back(vals[e]);
+        }
+        SparseTensor result(shape);
+        result.build(kept_coords, std::move(kept_vals));
+        return result;
+    }
+
+    /// Produit de Kronecker, même convention que Tensor::tensor_product (rangs complétés par des 1) :
+    /// nnz(A) * nnz(B) produits, aucun zéro multiplié
+    SparseTensor tensor_product(const SparseTensor& other) const
+    {
+        size_t nd = std::max(shape.size(), other.shape.size());
+        vector<size_t> shape_a(nd, 1), shape_b(nd, 1), new_shape(nd);
+        std::copy(shape.begin(), shape.end(), shape_a.begin());
+        std::copy(other.shape.begin(), other.shape.end(), shape_b.begin());
+        for (size_t k = 0; k < nd; ++k)
+            new_shape[k] = shape_a[k] * shape_b[k];
+
+        vector<size_t> ca, cb, coords;
+        vector<T> va, vb, vals;
+        entries(ca, va);
+        other.entries(cb, vb);
+        coords.reserve(va.size() * vb.size() * nd);
+        vals.reserve(va.size() * vb.size());
+
+        size_t ra = shape.size(), rb = other.shape.size();
+        for (size_t i = 0; i < va.size(); ++i)
+            for (size_t j = 0; j < vb.size(); ++j)
+            {
+                for (size_t k = 0; k < nd; ++k)
+                {
+                    size_t ia = k < ra ? ca[i * ra + k] : 0;
+                    size_t ib = k < rb ? cb[j * rb + k] : 0;
+                    coords.push_back(ia * shape_b[k] + ib);
+                }
+                vals.push_back(va[i] * vb[j]);
+            }
+
+        SparseTensor result(new_shape);
+        result.build_unsorted(coords, vals);
+        return result;
+    }
+
+    /// Trace sur deux axes de même taille (Tensor::contract)
+    SparseTensor contract(size_t axis1, size_t axis2) const
+    {
+        if (axis1 >= shape.size() || axis2 >= shape.size())
+            throw runtime_error("Invalid axis");
+        if (axis1 == axis2)
+            throw runtime_error("Cannot contract the same axis");
+        if (shape[axis1] != shape[axis2])
+            throw runtime_error("Cannot contract axes with different sizes");
+
+        vector<size_t> new_shape, coords;
+        vector<T> vals;
+        for (size_t i = 0; i < shape.size(); ++i)
+            if (i != axis1 && i != axis2)
+                new_shape.push_back(shape[i]);
+
+        for_each([&](const vector<size_t>& idx, const T& v)
+        {
+            if (idx[axis1] != idx[axis2])
+                return;
+            for (size_t i = 0; i < idx.size(); ++i)
+                if (i != axis1 && i != axis2)
+                    coords.push_back(idx[i]);
+            vals.push_back(v);
+        });
+
+        SparseTensor result(new_shape);
+        result.build_unsorted(coords, vals);
+        return result;
+    }
+
+    /// Contraction creux x creux ; axes restants de *this puis de B (Tensor::contract_with).
+    /// Les éléments de B sont regroupés par indice de l'axe contracté : seuls les couples
+    /// d'éléments stockés de même indice sont multipliés.
+    SparseTensor contract_with(const SparseTensor& B, size_t axis_A, size_t axis_B) const
+    {
+        if (axis_A >= shape.size() || axis_B >= B.shape.size())
+            throw runtime_error("Invalid axis");
+        if (shape[axis_A] != B.shape[axis_B])
+            throw runtime_error("Dimension mismatch for contraction");
+
+        vector<size_t> new_shape;
+        for (size_t i = 0; i < shape.size(); ++i)
+            if (i != axis_A) new_shape.push_back(shape[i]);
+        for (size_t i = 0; i < B.shape.size(); ++i)
+            if (i != axis_B) new_shape.push_back(B.shape[i]);
+
+        // Éléments de B rangés par indice contracté (tri par comptage)
+        size_t K = shape[axis_A], rb = B.shape.size() - 1;
+        vector<size_t> cb;
+        vector<T> vb;
+        B.entries(cb, vb);
+        vector<size_t> start(K + 1, 0);
+        for (size_t j = 0; j < vb.size(); ++j)
+            ++start[cb[j * (rb + 1) + axis_B] + 1];
+        std::partial_sum(start.begin(), start.end(), start.begin());
+
+        vector<size_t> b_rest(vb.size() * rb), fill = start;
+        vector<T> b_vals(vb.size());
+        for (size_t j = 0; j < vb.size(); ++j)
+        {
+            const size_t* c = cb.data() + j * (rb + 1);
+            size_t pos = fill[c[axis_B]]++;
+            for (size_t d = 0, o = 0; d <= rb; ++d)
+                if (d != axis_B) b_rest[pos * rb + o++] = c[d];
+            b_vals[pos] = vb[j];
+        }
+
+        vector<size_t> coords, a_rest;
+        vector<T> vals;
+        for_each([&](const vector<size_t>& idx, const T& v)
+        {
+            size_t k = idx[axis_A];
+            a_rest.clear();
+            for (size_t i = 0; i < idx.size(); ++i)
+                if (i != axis_A) a_rest.push_back(idx[i]);
+            for (size_t p = start[k]; p < start[k + 1]; ++p)
+            {
+                coords.insert(coords.end(), a_rest.begin(), a_rest.end());
+                coords.insert(coords.end(), b_rest.begin() + p * rb, b_rest.begin() + (p + 1) * rb);
+                vals.push_back(v * b_vals[p]);
+            }
+        });
+
+        SparseTensor result(new_shape);
+        result.build_unsorted(coords, vals);
+        return result;
+    }
+
+    /// Contraction creux x dense, résultat dense : une ligne de B (axe contracté en tête) par élément stocké
+    Tensor<T> contract_with(const Tensor<T>& B, size_t axis_A, size_t axis_B) const
+    {
+        const vector<size_t>& shape_B = B.get_shape();
+        if (axis_A >= shape.size() || axis_B >= shape_B.size())
+            throw runtime_error("Invalid axis");
+        if (shape[axis_A] != shape_B[axis_B])
+            throw runtime_error("Dimension mismatch for contraction");
+
+        vector<size_t> rest_A, new_shape, order_B{axis_B};
+        for (size_t i = 0; i < shape.size(); ++i)
+            if (i != axis_A) rest_A.push_back(shape[i]);
+        new_shape = rest_A;
+        for (size_t i = 0; i < shape_B.size(); ++i)
+            if (i != axis_B)
+            {
+                new_shape.push_back(shape_B[i]);
+                order_B.push_back(i);
+            }
+
+        Tensor<T> B_rows = B.view().permute(order_B).contiguous();
+        size_t row = shape[axis_A] ? B.size() / shape[axis_A] : 0;
+        const T* b = B_rows.data();
+
+        Tensor<T> result(new_shape, T(0));
+        T* out = result.data();
+        vector<size_t> a_rest(rest_A.size());
+        for_each([&](const vector<size_t>& idx, const T& v)
+        {
+            for (size_t i = 0, o = 0; i < idx.size(); ++i)
+                if (i != axis_A) a_rest[o++] = idx[i];
+            T* dst = out + linear(a_rest.data(), rest_A) * row;
+            const T* src = b + idx[axis_A] * row;
+            for (size_t j = 0; j < row; ++j)
+                dst[j] = dst[j] + v * src[j];
+        });
+        return result;
+    }
+
+    void print() const
+    {
+        cout << *this;
+    }
+
+    friend ostream& operator<<(ostream& os, const SparseTensor& t)
+    {
+        os << "SparseTensor (shape: ";
+        for (size_t i = 0; i < t.shape.size(); ++i)
+        {
+            os << t.shape[i];
+            if (i != t.shape.size() - 1) os << " x ";
+        }
+        os << ", nnz: " << t.nnz() << "):\n";
+        t.for_each([&](const vector<size_t>& idx, const T& v)
+        {
+            os << "(";
+            for (size_t j = 0; j < idx.size(); ++j)
+            {
+                os << idx[j];
+                if (j != idx.size() - 1) os << ", ";
+            }
+            os << ") = " << v << "\n";
+        });
+        return os;
+    }
+};
+
+/// Contraction dense x creux (axes restants de A puis de B) : calculée comme B x A puis permutée
+template<typename T>
+Tensor<T> contract_with(const Tensor<T>& A, const SparseTensor<T>& B, size_t axis_A, size_t axis_B)
+{
+    Tensor<T> BA = B.contract_with(A, axis_B, axis_A);
+    size_t rest_B = B.ndim() - 1, rest_A = A.ndim() - 1;
+    vector<size_t> order;
+    for (size_t i = 0; i < rest_A; ++i) order.push_back(rest_B + i);
+    for (size_t i = 0; i < rest_B; ++i) order.push_back(i);
+    if (order.empty())
+        return BA;
+    return BA.permute(order);
+}
+
+#endif // TENSEURS_SPARSE_H_INCLUDED
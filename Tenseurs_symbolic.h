@@ -0,0 +1,903 @@
+///  -------------------------------------------------
+///  Symbol : scalaire symbolique pour Tensor<Symbol>
+///  StandAlone class, header only
+///  Coded by JP CHAMPEAUX
+///  contact : JPC@irsamc.upse-tlse.fr
+///  Free of use for Academic purpose only !
+///  (please, just mention author in your works if used or if your own code is inspired from it)
+///  CLASS Symbol
+///  --------------------------------------------------
+
+
+#ifndef TENSEURS_SYMBOLIC_H_INCLUDED
+#define TENSEURS_SYMBOLIC_H_INCLUDED
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "Tenseurs.h"
+
+enum class SymbolKind
+{
+    Constant,
+    Variable,
+    Add,    // a + b
+    Mul,    // a * b
+    Pow     // a ^ n (n entier, constante)
+};
+
+namespace tensor_symbolic
+{
+
+/// Noeud du DAG : immuable, unique pour une structure donnée (hash-consing).
+/// Deux expressions égales structurellement partagent le même noeud : égalité par pointeur.
+struct Node
+{
+    SymbolKind kind;
+    const Node* a = nullptr;
+    const Node* b = nullptr;
+    double value = 0;   // Constant (et exposant de Pow)
+    string name;        // Variable
+    size_t id = 0;      // ordre de création : ordre canonique des opérandes commutatifs
+    size_t hash = 0;
+};
+
+inline size_t hash_combine(size_t h, size_t v)
+{
+    return h ^ (v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2));
+}
+
+inline size_t node_hash(SymbolKind kind, const Node* a, const Node* b, double value, const string& name)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    size_t h = hash_combine(static_cast<size_t>(kind), a ? a->id : 0);
+    h = hash_combine(h, b ? b->id : 0);
+    h = hash_combine(h, static_cast<size_t>(bits));
+    return hash_combine(h, std::hash<string>()(name));
+}
+
+/// Table des noeuds (un par processus). Les noeuds ne sont jamais libérés :
+/// la mémoire suit le nombre d'expressions distinctes, pas le nombre d'opérations.
+class NodeTable
+{
+    struct Key
+    {
+        const Node* node;
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& k) const
+        {
+            return k.node->hash;
+        }
+    };
+
+    struct KeyEqual
+    {
+        bool operator()(const Key& x, const Key& y) const
+        {
+            const Node& p = *x.node;
+            const Node& q = *y.node;
+            return p.kind == q.kind && p.a == q.a && p.b == q.b && p.name == q.name
+                && std::memcmp(&p.value, &q.value, sizeof(double)) == 0;
+        }
+    };
+
+    std::deque<Node> nodes;  // adresses stables
+    std::unordered_set<Key, KeyHash, KeyEqual> index;
+    std::mutex lock;
+
+public:
+    const Node* intern(SymbolKind kind, const Node* a, const Node* b, double value, const string& name)
+    {
+        if (value == 0)
+            value = 0;  // -0.0 et 0.0 : même constante
+
+        Node probe;
+        probe.kind = kind;
+        probe.a = a;
+        probe.b = b;
+        probe.value = value;
+        probe.name = name;
+        probe.hash = node_hash(kind, a, b, value, name);
+
+        std::lock_guard<std::mutex> guard(lock);
+        auto it = index.find(Key{&probe});
+        if (it != index.end())
+            return it->node;
+
+        probe.id = nodes.size() + 1;
+        nodes.push_back(std::move(probe));
+        const Node* node = &nodes.back();
+        index.insert(Key{node});
+        return node;
+    }
+
+    size_t size()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        return nodes.size();
+    }
+
+    static NodeTable& instance()
+    {
+        static NodeTable table;
+        return table;
+    }
+};
+
+} // namespace tensor_symbolic
+
+/// Scalaire symbolique à noeuds partagés : chaque opération coûte O(1) (recherche dans la table),
+/// les sous-expressions identiques ne sont stockées qu'une fois, == compare des pointeurs.
+/// Simplifications locales à la construction : 0 + x = x, 0 * x = 0, 1 * x = x, c1 x + c2 x = (c1 + c2) x,
+/// x * x = x^2, constantes pliées ; a + b et b + a donnent le même noeud.
+///     Symbol x("x"), y("y");
+///     Tensor<Symbol> A({4, 4, 4, 4}, x); ... A.contract_with(B, 3, 0);
+class Symbol
+{
+public:
+    using Node = tensor_symbolic::Node;
+
+private:
+    const Node* node;
+
+    explicit Symbol(const Node* n)
+        : node(n)
+    {
+    }
+
+    static const Node* make(SymbolKind kind, const Node* a, const Node* b, double value = 0, const string& name = string())
+    {
+        return tensor_symbolic::NodeTable::instance().intern(kind, a, b, value, name);
+    }
+
+    static const Node* constant(double c)
+    {
+        return make(SymbolKind::Constant, nullptr, nullptr, c);
+    }
+
+    static bool is_const(const Node* n, double c)
+    {
+        return n->kind == SymbolKind::Constant && n->value == c;
+    }
+
+    // Opérandes commutatifs : constante d'abord, puis ordre de création
+    static void order(const Node*& a, const Node*& b)
+    {
+        bool a_const = a->kind == SymbolKind::Constant, b_const = b->kind == SymbolKind::Constant;
+        if ((b_const && !a_const) || (a_const == b_const && b->id < a->id))
+            std::swap(a, b);
+    }
+
+    // c * x -> (c, x), sinon (1, x)
+    static double split_coefficient(const Node*& n)
+    {
+        if (n->kind == SymbolKind::Mul && n->a->kind == SymbolKind::Constant)
+        {
+            double c = n->a->value;
+            n = n->b;
+            return c;
+        }
+        return 1;
+    }
+
+    static const Node* add(const Node* a, const Node* b)
+    {
+        if (is_const(a, 0)) return b;
+        if (is_const(b, 0)) return a;
+        if (a->kind == SymbolKind::Constant && b->kind == SymbolKind::Constant)
+            return constant(a->value + b->value);
+        // c1 * x + c2 * x = (c1 + c2) * x
+        const Node* base_a = a;
+        const Node* base_b = b;
+        double ca = split_coefficient(base_a), cb = split_coefficient(base_b);
+        if (base_a == base_b)
+            return mul(constant(ca + cb), base_a);
+        order(a, b);
+        return make(SymbolKind::Add, a, b);
+    }
+
+    static const Node* mul(const Node* a, const Node* b)
+    {
+        order(a, b);
+        if (is_const(a, 0)) return a;
+        if (is_const(a, 1)) return b;
+        if (a->kind == SymbolKind::Constant && b->kind == SymbolKind::Constant)
+            return constant(a->value * b->value);
+        // c1 * (c2 * x) = (c1 c2) * x
+        if (a->kind == SymbolKind::Constant && b->kind == SymbolKind::Mul && b->a->kind == SymbolKind::Constant)
+            return mul(constant(a->value * b->a->value), b->b);
+        if (a == b)
+            return pow(a, 2);
+        return make(SymbolKind::Mul, a, b);
+    }
+
+    static const Node* pow(const Node* a, int n)
+    {
+        if (n == 0) return constant(1);
+        if (n == 1) return a;
+        if (a->kind == SymbolKind::Constant)
+            return constant(std::pow(a->value, n));
+        if (a->kind == SymbolKind::Pow)
+            return pow(a->a, n * static_cast<int>(a->value));
+        return make(SymbolKind::Pow, a, nullptr, n);
+    }
+
+    static void print(ostream& os, const Node* n)
+    {
+        switch (n->kind)
+        {
+        case SymbolKind::Constant:
+            os << n->value;
+            break;
+        case SymbolKind::Variable:
+            os << n->name;
+            break;
+        case SymbolKind::Add:
+            os << "(";
+            print(os, n->a);
+            os << "+";
+            print(os, n->b);
+            os << ")";
+            break;
+        case SymbolKind::Mul:
+            if (is_const(n->a, -1))
+                os << "-";
+            else
+            {
+                print(os, n->a);
+                os << "*";
+            }
+            print(os, n->b);
+            break;
+        case SymbolKind::Pow:
+            if (n->a->kind == SymbolKind::Add || n->a->kind == SymbolKind::Variable || n->a->kind == SymbolKind::Constant)
+                print(os, n->a);
+            else
+            {
+                os << "(";
+                print(os, n->a);
+                os << ")";
+            }
+            os << "^" << static_cast<int>(n->value);
+            break;
+        }
+    }
+
+public:
+    // 0 : Tensor<Symbol>(shape) est nul
+    Symbol()
+        : node(constant(0))
+    {
+    }
+
+    template<typename U, typename std::enable_if<std::is_arithmetic<U>::value, int>::type = 0>
+    Symbol(U value)
+        : node(constant(static_cast<double>(value)))
+    {
+    }
+
+    // Variable
+    Symbol(const string& name)
+        : node(make(SymbolKind::Variable, nullptr, nullptr, 0, name))
+    {
+    }
+
+    Symbol(const char* name)
+        : Symbol(string(name))
+    {
+    }
+
+    friend Symbol operator+(const Symbol& x, const Symbol& y)
+    {
+        return Symbol(add(x.node, y.node));
+    }
+
+    friend Symbol operator*(const Symbol& x, const Symbol& y)
+    {
+        return Symbol(mul(x.node, y.node));
+    }
+
+    friend Symbol operator-(const Symbol& x)
+    {
+        return Symbol(mul(constant(-1), x.node));
+    }
+
+    friend Symbol operator-(const Symbol& x, const Symbol& y)
+    {
+        return x + (-y);
+    }
+
+    friend Symbol operator/(const Symbol& x, const Symbol& y)
+    {
+        if (is_const(y.node, 0))
+            throw runtime_error("Symbolic division by zero");
+        if (y.node->kind == SymbolKind::Constant)
+            return Symbol(mul(constant(1 / y.node->value), x.node));
+        return Symbol(mul(x.node, pow(y.node, -1)));
+    }
+
+    friend Symbol pow(const Symbol& x, int n)
+    {
+        return Symbol(pow(x.node, n));
+    }
+
+    Symbol& operator+=(const Symbol& y)
+    {
+        return *this = *this + y;
+    }
+
+    Symbol& operator-=(const Symbol& y)
+    {
+        return *this = *this - y;
+    }
+
+    Symbol& operator*=(const Symbol& y)
+    {
+        return *this = *this * y;
+    }
+
+    Symbol& operator/=(const Symbol& y)
+    {
+        return *this = *this / y;
+    }
+
+    // Égalité structurelle = égalité des noeuds
+    friend bool operator==(const Symbol& x, const Symbol& y)
+    {
+        return x.node == y.node;
+    }
+
+    friend bool operator!=(const Symbol& x, const Symbol& y)
+    {
+        return x.node != y.node;
+    }
+
+    SymbolKind kind() const
+    {
+        return node->kind;
+    }
+
+    bool is_constant() const
+    {
+        return node->kind == SymbolKind::Constant;
+    }
+
+    // Constante, ou exposant d'une puissance
+    double value() const
+    {
+        return node->value;
+    }
+
+    const string& name() const
+    {
+        return node->name;
+    }
+
+    // Opérandes (Add, Mul : deux ; Pow : la base)
+    Symbol lhs() const
+    {
+        return Symbol(node->a);
+    }
+
+    Symbol rhs() const
+    {
+        return Symbol(node->b);
+    }
+
+    const Node* get_node() const
+    {
+        return node;
+    }
+
+    // Identifiant unique du noeud
+    size_t id() const
+    {
+        return node->id;
+    }
+
+    /// Valeur numérique ; chaque noeud partagé n'est évalué qu'une fois
+    double evaluate(const std::unordered_map<string, double>& variables) const
+    {
+        std::unordered_map<const Node*, double> memo;
+        std::function<double(const Node*)> eval = [&](const Node* n) -> double
+        {
+            auto it = memo.find(n);
+            if (it != memo.end())
+                return it->second;
+            double r = 0;
+            switch (n->kind)
+            {
+            case SymbolKind::Constant: r = n->value; break;
+            case SymbolKind::Variable:
+            {
+                auto v = variables.find(n->name);
+                if (v == variables.end())
+                    throw runtime_error("Unbound symbolic variable: " + n->name);
+                r = v->second;
+                break;
+            }
+            case SymbolKind::Add: r = eval(n->a) + eval(n->b); break;
+            case SymbolKind::Mul: r = eval(n->a) * eval(n->b); break;
+            case SymbolKind::Pow: r = std::pow(eval(n->a), n->value); break;
+            }
+            memo.emplace(n, r);
+            return r;
+        };
+        return eval(node);
+    }
+
+    string to_string() const
+    {
+        std::ostringstream os;
+        os << *this;
+        return os.str();
+    }
+
+    friend ostream& operator<<(ostream& os, const Symbol& s)
+    {
+        print(os, s.node);
+        return os;
+    }
+
+    // Nombre de noeuds distincts créés depuis le début du processus
+    static size_t interned_count()
+    {
+        return tensor_symbolic::NodeTable::instance().size();
+    }
+};
+
+namespace std
+{
+template<>
+struct hash<Symbol>
+{
+    size_t operator()(const Symbol& s) const
+    {
+        return std::hash<const void*>()(s.get_node());
+    }
+};
+}
+
+/// Noyau numérique compilé depuis un Tensor<Symbol>.
+/// Le DAG de toutes les composantes est parcouru une fois : une sous-expression commune
+/// à plusieurs composantes n'est calculée qu'une fois (CSE par le hash-consing).
+/// a + (-1)*b, a * b^-1, -1*a et a^2 deviennent Sub, Div, Neg et Mul.
+/// Le bytecode s'exécute sur des blocs de LANES points : chaque instruction passe par les
+/// noyaux SIMD de Tenseurs_kernels.h sur les LANES valeurs d'un registre. Les registres temporaires sont réutilisés.
+///     SymbolicKernel k(C, {"x", "y"});
+///     Tensor<double> out = k.evaluate(points);   // points : {N, 2} -> out : {N, shape de C}
+class SymbolicKernel
+{
+public:
+    static constexpr size_t LANES = 64;
+    static constexpr size_t STAGE = 256;
+
+    enum class Op : uint8_t
+    {
+        Add,
+        Sub,
+        Mul,
+        Div,
+        Neg,
+        Pow,    // exposant entier
+        Store   // composante dst <- registre a
+    };
+
+    struct Instruction
+    {
+        Op op;
+        size_t dst;
+        size_t a;
+        size_t b;
+        int exponent;
+    };
+
+private:
+    using Node = tensor_symbolic::Node;
+
+    vector<size_t> shape;
+    size_t n_components = 0;
+    vector<string> variables;
+    vector<double> constants;      // registres [n_vars, n_vars + n_constants)
+    vector<Instruction> ssa;       // une valeur par instruction, pour to_cpp
+    vector<Instruction> code;      // registres physiques, pour evaluate
+    size_t n_registers = 0;
+
+    static bool is_neg(const Node* n)
+    {
+        return n->kind == SymbolKind::Mul && n->a->kind == SymbolKind::Constant && n->a->value == -1;
+    }
+
+    static bool is_inverse(const Node* n)
+    {
+        return n->kind == SymbolKind::Pow && n->value == -1;
+    }
+
+    static double powi(double x, int n)
+    {
+        if (n < 0)
+            return 1 / powi(x, -n);
+        double r = 1;
+        while (n)
+        {
+            if (n & 1)
+                r *= x;
+            x *= x;
+            n >>= 1;
+        }
+        return r;
+    }
+
+    void compile(const Tensor<Symbol>& expr)
+    {
+        const size_t n_vars = variables.size();
+        std::unordered_map<const Node*, size_t> value;
+        for (size_t k = 0; k < n_vars; ++k)
+            value[Symbol(variables[k]).get_node()] = k;
+
+        std::unordered_map<const Node*, size_t> constant_index;
+        std::vector<const Node*> constant_nodes;
+        auto constant_register = [&](const Node* n) -> size_t
+        {
+            auto it = constant_index.find(n);
+            if (it != constant_index.end())
+                return it->second;
+            size_t k = constant_nodes.size();
+            constant_nodes.push_back(n);
+            constant_index.emplace(n, k);
+            return k;
+        };
+
+        // Valeurs SSA : variables, puis constantes (numérotées après coup), puis temporaires
+        const size_t TEMP = size_t(1) << (8 * sizeof(size_t) - 2);
+        const size_t CONST = TEMP >> 1;
+        size_t n_temps = 0;
+        auto emit = [&](Op op, size_t a, size_t b, int exponent) -> size_t
+        {
+            ssa.push_back(Instruction{op, TEMP + n_temps, a, b, exponent});
+            return TEMP + n_temps++;
+        };
+
+        // Opérandes réellement lus par le noeud, selon la forme choisie
+        auto operands = [](const Node* n, const Node*& x, const Node*& y)
+        {
+            x = y = nullptr;
+            switch (n->kind)
+            {
+            case SymbolKind::Add:
+                if (is_neg(n->b)) { x = n->a; y = n->b->b; }
+                else if (is_neg(n->a)) { x = n->b; y = n->a->b; }
+                else { x = n->a; y = n->b; }
+                break;
+            case SymbolKind::Mul:
+                if (is_neg(n)) x = n->b;
+                else if (is_inverse(n->b)) { x = n->a; y = n->b->a; }
+                else if (is_inverse(n->a)) { x = n->b; y = n->a->a; }
+                else { x = n->a; y = n->b; }
+                break;
+            case SymbolKind::Pow:
+                x = n->a;
+                break;
+            default:
+                break;
+            }
+        };
+
+        const Symbol* components = expr.get_data().data();
+        vector<pair<const Node*, bool>> stack;
+        for (size_t c = 0; c < n_components; ++c)
+        {
+            stack.push_back({components[c].get_node(), false});
+            while (!stack.empty())
+            {
+                const Node* n = stack.back().first;
+                bool expanded = stack.back().second;
+                stack.pop_back();
+                if (value.count(n))
+                    continue;
+
+                if (n->kind == SymbolKind::Constant)
+                {
+                    value[n] = CONST + constant_register(n);
+                    continue;
+                }
+                if (n->kind == SymbolKind::Variable)
+                    throw runtime_error("Variable not listed in the kernel inputs: " + n->name);
+
+                const Node* x;
+                const Node* y;
+                operands(n, x, y);
+                if (!expanded)
+                {
+                    stack.push_back({n, true});
+                    if (y && !value.count(y))
+                        stack.push_back({y, false});
+                    if (!value.count(x))
+                        stack.push_back({x, false});
+                    continue;
+                }
+
+                size_t vx = value[x], vy = y ? value[y] : 0;
+                size_t r;
+                switch (n->kind)
+                {
+                case SymbolKind::Add:
+                    r = emit(x == n->a && y == n->b ? Op::Add : Op::Sub, vx, vy, 0);
+                    break;
+                case SymbolKind::Mul:
+                    if (!y) r = emit(Op::Neg, vx, 0, 0);
+                    else if (is_inverse(n->a) || is_inverse(n->b)) r = emit(Op::Div, vx, vy, 0);
+                    else r = emit(Op::Mul, vx, vy, 0);
+                    break;
+                default:
+                    if (n->value == 2)
+                        r = emit(Op::Mul, vx, vx, 0);
+                    else
+                        r = emit(Op::Pow, vx, 0, static_cast<int>(n->value));
+                    break;
+                }
+                value[n] = r;
+            }
+            ssa.push_back(Instruction{Op::Store, c, value[components[c].get_node()], 0, 0});
+        }
+
+        // Numérotation définitive des constantes et des temporaires
+        for (const Node* n : constant_nodes)
+            constants.push_back(n->value);
+        const size_t base = n_vars + constants.size();
+        auto resolve = [&](size_t v) -> size_t
+        {
+            if (v >= TEMP) return base + (v - TEMP);
+            if (v >= CONST) return n_vars + (v - CONST);
+            return v;
+        };
+        auto reads = [](const Instruction& ins)
+        {
+            return ins.op == Op::Add || ins.op == Op::Sub || ins.op == Op::Mul || ins.op == Op::Div ? 2 : 1;
+        };
+        for (Instruction& ins : ssa)
+        {
+            if (ins.op != Op::Store)
+                ins.dst = resolve(ins.dst);
+            ins.a = resolve(ins.a);
+            if (reads(ins) == 2)
+                ins.b = resolve(ins.b);
+        }
+
+        // Allocation des registres : un temporaire est libéré après sa dernière lecture
+        vector<size_t> last_use(n_temps, 0);
+        for (size_t i = 0; i < ssa.size(); ++i)
+        {
+            const Instruction& ins = ssa[i];
+            if (ins.a >= base) last_use[ins.a - base] = i;
+            if (reads(ins) == 2 && ins.b >= base) last_use[ins.b - base] = i;
+        }
+        vector<size_t> physical(n_temps);
+        vector<size_t> free_list;
+        size_t n_physical = 0;
+        code.reserve(ssa.size());
+        for (size_t i = 0; i < ssa.size(); ++i)
+        {
+            Instruction ins = ssa[i];
+            auto map_read = [&](size_t& v)
+            {
+                if (v < base)
+                    return;
+                size_t t = v - base;
+                v = base + physical[t];
+                if (last_use[t] == i)
+                    free_list.push_back(physical[t]);
+            };
+            map_read(ins.a);
+            if (reads(ins) == 2 && ins.b != ssa[i].a)
+                map_read(ins.b);
+            else if (reads(ins) == 2)
+                ins.b = ins.a;
+            if (ins.op != Op::Store)
+            {
+                size_t t = ins.dst - base, p;
+                if (free_list.empty())
+                    p = n_physical++;
+                else
+                {
+                    p = free_list.back();
+                    free_list.pop_back();
+                }
+                physical[t] = p;
+                ins.dst = base + p;
+            }
+            code.push_back(ins);
+        }
+        n_registers = base + n_physical;
+    }
+
+    // Évalue count <= LANES points à partir de first
+    void run_block(const double* inputs, size_t first, size_t count, double* outputs, double* regs, double* stage) const
+    {
+        const size_t n_vars = variables.size();
+        for (size_t k = 0; k < n_vars; ++k)
+        {
+            double* r = regs + k * LANES;
+            for (size_t l = 0; l < count; ++l)
+                r[l] = inputs[(first + l) * n_vars + k];
+            for (size_t l = count; l < LANES; ++l)
+                r[l] = 0;
+        }
+
+        const tensor_kernels::SimdKernels<double>& simd = tensor_kernels::simd<double>();
+        for (const Instruction& ins : code)
+        {
+            double* d = regs + ins.dst * LANES;
+            const double* a = regs + ins.a * LANES;
+            const double* b = regs + ins.b * LANES;
+            switch (ins.op)
+            {
+            case Op::Add: simd.binary(tensor_kernels::ElementOp::Add, a, b, d, LANES); break;
+            case Op::Sub: simd.binary(tensor_kernels::ElementOp::Sub, a, b, d, LANES); break;
+            case Op::Mul: simd.binary(tensor_kernels::ElementOp::Mul, a, b, d, LANES); break;
+            case Op::Div: simd.binary(tensor_kernels::ElementOp::Div, a, b, d, LANES); break;
+            case Op::Neg: simd.binary_scalar(tensor_kernels::ElementOp::Mul, a, -1.0, d, LANES); break;
+            case Op::Pow: for (size_t l = 0; l < LANES; ++l) d[l] = powi(a[l], ins.exponent); break;
+            case Op::Store:
+            {
+                // Les composantes sont écrites dans l'ordre : tuiles de STAGE composantes
+                // transposées d'un bloc, pour écrire des lignes contiguës de la sortie
+                size_t c = ins.dst, c0 = c - c % STAGE;
+                std::memcpy(stage + (c - c0) * LANES, a, LANES * sizeof(double));
+                if (c + 1 - c0 == STAGE || c + 1 == n_components)
+                {
+                    for (size_t l = 0; l < count; ++l)
+                    {
+                        double* o = outputs + (first + l) * n_components + c0;
+                        for (size_t j = 0; j <= c - c0; ++j)
+                            o[j] = stage[j * LANES + l];
+                    }
+                }
+                break;
+            }
+            }
+        }
+    }
+
+public:
+    /// expr : résultat symbolique ; variables : ordre des valeurs d'entrée de chaque point
+    SymbolicKernel(const Tensor<Symbol>& expr, const vector<string>& variables_)
+        : shape(expr.get_shape()), n_components(expr.size()), variables(variables_)
+    {
+        compile(expr);
+    }
+
+    /// inputs : count points de n_variables() valeurs ; outputs : count * n_components() valeurs
+    void evaluate(const double* inputs, size_t count, double* outputs) const
+    {
+        const size_t n_blocks = (count + LANES - 1) / LANES;
+        const size_t grain = std::max<size_t>(1, tensor_kernels::PARALLEL_GRAIN / (LANES * std::max<size_t>(1, code.size())));
+        tensor_kernels::parallel_for(0, n_blocks, grain, [&](size_t b0, size_t b1)
+        {
+            vector<double, AlignedAllocator<double>> regs((n_registers + STAGE) * LANES);
+            for (size_t k = 0; k < constants.size(); ++k)
+                std::fill_n(regs.data() + (variables.size() + k) * LANES, LANES, constants[k]);
+            double* stage = regs.data() + n_registers * LANES;
+            for (size_t blk = b0; blk < b1; ++blk)
+            {
+                size_t first = blk * LANES;
+                run_block(inputs, first, std::min(LANES, count - first), outputs, regs.data(), stage);
+            }
+        });
+    }
+
+    /// inputs de forme {n_variables()} : résultat de la forme du tenseur compilé ;
+    /// {N, n_variables()} : résultat {N, forme...}
+    Tensor<double> evaluate(const Tensor<double>& inputs) const
+    {
+        const vector<size_t>& in_shape = inputs.get_shape();
+        bool batch = in_shape.size() == 2;
+        if ((in_shape.size() != 1 && !batch) || in_shape.back() != variables.size())
+            throw runtime_error("Kernel inputs must have shape {n_variables} or {N, n_variables}");
+
+        size_t count = batch ? in_shape[0] : 1;
+        vector<size_t> out_shape;
+        if (batch)
+            out_shape.push_back(count);
+        out_shape.insert(out_shape.end(), shape.begin(), shape.end());
+        Tensor<double> result(out_shape);
+        evaluate(inputs.get_data().data(), count, result.data());
+        return result;
+    }
+
+    /// Source C++ autonome : name(in, out) pour un point, name_batch(count, in, out) pour count points
+    string to_cpp(const string& name = "tensor_kernel") const
+    {
+        const size_t n_vars = variables.size();
+        const size_t base = n_vars + constants.size();
+        auto ref = [&](size_t v)
+        {
+            if (v < n_vars) return "v" + std::to_string(v);
+            if (v < base) return "c" + std::to_string(v - n_vars);
+            return "t" + std::to_string(v - base);
+        };
+
+        std::ostringstream os;
+        os.precision(17);
+        os << "// " << n_components << " components, " << ssa.size() - n_components << " operations\n";
+        os << "#include <cstddef>\n\n";
+        os << "static inline double " << name << "_powi(double x, int n)\n{\n"
+           << "    if (n < 0) return 1 / " << name << "_powi(x, -n);\n"
+           << "    double r = 1;\n"
+           << "    for (; n; n >>= 1, x *= x) if (n & 1) r *= x;\n"
+           << "    return r;\n}\n\n";
+        os << "void " << name << "(const double* in, double* out)\n{\n";
+        for (size_t k = 0; k < n_vars; ++k)
+            os << "    const double v" << k << " = in[" << k << "]; // " << variables[k] << "\n";
+        for (size_t k = 0; k < constants.size(); ++k)
+            os << "    const double c" << k << " = " << constants[k] << ";\n";
+        for (const Instruction& ins : ssa)
+        {
+            if (ins.op == Op::Store)
+            {
+                os << "    out[" << ins.dst << "] = " << ref(ins.a) << ";\n";
+                continue;
+            }
+            os << "    const double " << ref(ins.dst) << " = ";
+            switch (ins.op)
+            {
+            case Op::Add: os << ref(ins.a) << " + " << ref(ins.b); break;
+            case Op::Sub: os << ref(ins.a) << " - " << ref(ins.b); break;
+            case Op::Mul: os << ref(ins.a) << " * " << ref(ins.b); break;
+            case Op::Div: os << ref(ins.a) << " / " << ref(ins.b); break;
+            case Op::Neg: os << "-" << ref(ins.a); break;
+            case Op::Pow: os << name << "_powi(" << ref(ins.a) << ", " << ins.exponent << ")"; break;
+            case Op::Store: break;
+            }
+            os << ";\n";
+        }
+        os << "}\n\n";
+        os << "void " << name << "_batch(std::size_t count, const double* in, double* out)\n{\n"
+           << "    for (std::size_t s = 0; s < count; ++s)\n"
+           << "        " << name << "(in + s * " << n_vars << ", out + s * " << n_components << ");\n}\n";
+        return os.str();
+    }
+
+    const vector<size_t>& get_shape() const
+    {
+        return shape;
+    }
+
+    size_t n_variables() const
+    {
+        return variables.size();
+    }
+
+    // Nombre de composantes écrites par point
+    size_t size() const
+    {
+        return n_components;
+    }
+
+    const vector<Instruction>& instructions() const
+    {
+        return code;
+    }
+
+    size_t register_count() const
+    {
+        return n_registers;
+    }
+};
+
+#endif // TENSEURS_SYMBOLIC_H_INCLUDED
@@ -0,0 +1,652 @@
+///  -------------------------------------------------
+///  Tenseurs symétriques / antisymétriques en stockage compact
+///  StandAlone class, header only
+///  Coded by JP CHAMPEAUX
+///  contact : JPC@irsamc.upse-tlse.fr
+///  Free of use for Academic purpose only !
+///  (please, just mention author in your works if used or if your own code is inspired from it)
+///  CLASS PackedTensor, RiemannTensor
+///  --------------------------------------------------
+
+
+#ifndef TENSEURS_SYMMETRIC_H_INCLUDED
+#define TENSEURS_SYMMETRIC_H_INCLUDED
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <utility>
+
+#include "Tenseurs.h"
+
+enum class Symmetry
+{
+    Symmetric,      // T_..i..j.. = T_..j..i..
+    Antisymmetric   // T_..i..j.. = -T_..j..i.. (nul si deux indices sont égaux)
+};
+
+namespace tensor_packed
+{
+
+template<typename T>
+T negate(const T& v)
+{
+    return T(-1) * v;
+}
+
+template<typename T>
+bool is_zero(const T& v)
+{
+    if constexpr (std::is_arithmetic<T>::value)
+        return v == T(0);
+    else
+        return false;
+}
+
+/// Référence signée vers une composante stockée : A(1, 0) = x écrit -x dans A(0, 1).
+/// sign == 0 : composante identiquement nulle (antisymétrie, indices répétés).
+template<typename T>
+class SignedReference
+{
+    T* ptr;
+    int sign;
+
+public:
+    SignedReference(T* ptr_, int sign_)
+        : ptr(ptr_), sign(sign_)
+    {
+    }
+
+    operator T() const
+    {
+        if (sign == 0) return T(0);
+        return sign > 0 ? *ptr : negate(*ptr);
+    }
+
+    SignedReference& operator=(const T& v)
+    {
+        if (sign == 0)
+        {
+            if (!is_zero(v))
+                throw runtime_error("Antisymmetric component with repeated indices is always zero");
+            return *this;
+        }
+        *ptr = sign > 0 ? v : negate(v);
+        return *this;
+    }
+
+    SignedReference& operator=(const SignedReference& other)
+    {
+        return *this = static_cast<T>(other);
+    }
+
+    SignedReference& operator+=(const T& v)
+    {
+        return *this = static_cast<T>(*this) + v;
+    }
+
+    SignedReference& operator-=(const T& v)
+    {
+        return *this = static_cast<T>(*this) + negate(v);
+    }
+};
+
+} // namespace tensor_packed
+
+/// Tenseur de rang r sur n dimensions, complètement symétrique ou antisymétrique :
+/// seules les composantes d'indices triés sont stockées,
+/// C(n + r - 1, r) en symétrique (10 pour une métrique 4x4), C(n, r) en antisymétrique.
+/// operator() accepte les indices dans n'importe quel ordre et applique le signe.
+template<typename T, Symmetry S>
+class PackedTensor
+{
+private:
+    size_t dim = 0;
+    size_t rnk = 0;
+    vector<T> values;
+    vector<size_t> binom;  // C(a, b) = binom[a * (rnk + 1) + b]
+
+    size_t choose(size_t a, size_t b) const
+    {
+        return binom[a * (rnk + 1) + b];
+    }
+
+    void init_binomials()
+    {
+        size_t top = dim + rnk + 1;
+        binom.assign(top * (rnk + 1), 0);
+        for (size_t a = 0; a < top; ++a)
+        {
+            binom[a * (rnk + 1)] = 1;
+            for (size_t b = 1; b <= std::min(a, rnk); ++b)
+                binom[a * (rnk + 1) + b] = binom[(a - 1) * (rnk + 1) + b - 1] + binom[(a - 1) * (rnk + 1) + b];
+        }
+    }
+
+    /// Trie idx[0 .. rnk) sur place ; renvoie le signe de la permutation (0 si antisymétrique et indices répétés)
+    int canonicalize(size_t* idx) const
+    {
+        int sign = 1;
+        for (size_t i = 1; i < rnk; ++i)
+            for (size_t j = i; j > 0 && idx[j - 1] > idx[j]; --j)
+            {
+                std::swap(idx[j - 1], idx[j]);
+                sign = -sign;
+            }
+        for (size_t d = 0; d < rnk; ++d)
+        {
+            if (idx[d] >= dim)
+                throw out_of_range("Index out of bounds");
+            if (S == Symmetry::Antisymmetric && d > 0 && idx[d] == idx[d - 1])
+                return 0;
+        }
+        return S == Symmetry::Symmetric ? 1 : sign;
+    }
+
+    /// Rang d'un multi-indice trié (système combinatoire) ; en symétrique i_k + k est strictement croissant
+    size_t rank_of(const size_t* sorted) const
+    {
+        size_t pos = 0;
+        for (size_t k = 0; k < rnk; ++k)
+            pos += choose(sorted[k] + (S == Symmetry::Symmetric ? k : 0), k + 1);
+        return pos;
+    }
+
+    /// Multi-indice trié suivant (ordre lexicographique) ; false après le dernier
+    bool next_sorted(vector<size_t>& idx) const
+    {
+        for (size_t k = rnk; k-- > 0;)
+        {
+            // Valeur maximale de idx[k] pour que les positions suivantes restent valides
+            size_t max_k = S == Symmetry::Symmetric ? dim - 1 : dim - (rnk - k);
+            if (idx[k] < max_k)
+            {
+                ++idx[k];
+                for (size_t j = k + 1; j < rnk; ++j)
+                    idx[j] = S == Symmetry::Symmetric ? idx[k] : idx[j - 1] + 1;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template<typename... Args>
+    size_t locate(int& sign, Args... args) const
+    {
+        if (sizeof...(Args) != rnk)
+            throw runtime_error("Index dimension mismatch");
+        size_t idx[sizeof...(Args) + 1] = {static_cast<size_t>(args)...};
+        sign = canonicalize(idx);
+        return sign ? rank_of(idx) : 0;
+    }
+
+    size_t locate_indices(int& sign, vector<size_t> idx) const
+    {
+        if (idx.size() != rnk)
+            throw runtime_error("Index dimension mismatch");
+        sign = canonicalize(idx.data());
+        return sign ? rank_of(idx.data()) : 0;
+    }
+
+public:
+    PackedTensor() = default;
+
+    PackedTensor(size_t dim_, size_t rank_, T init_val = T())
+        : dim(dim_), rnk(rank_)
+    {
+        init_binomials();
+        size_t n = 1;
+        if (rnk > 0)
+        {
+            if (S == Symmetry::Symmetric)
+                n = dim ? choose(dim + rnk - 1, rnk) : 0;
+            else
+                n = rnk <= dim ? choose(dim, rnk) : 0;
+        }
+        values.assign(n, init_val);
+    }
+
+    /// Composantes d'indices triés d'un tenseur dense (les autres ne sont pas lues)
+    explicit PackedTensor(const Tensor<T>& dense)
+    {
+        const vector<size_t>& shape = dense.get_shape();
+        size_t n = shape.empty() ? 1 : shape[0];
+        for (size_t d : shape)
+            if (d != n)
+                throw runtime_error("Packed tensors need equal dimensions on all axes");
+        *this = PackedTensor(n, shape.size());
+        for_each_component([&](const vector<size_t>& idx, T& v)
+        {
+            v = dense.at(idx);
+        });
+    }
+
+    size_t get_dim() const
+    {
+        return dim;
+    }
+
+    size_t ndim() const
+    {
+        return rnk;
+    }
+
+    vector<size_t> get_shape() const
+    {
+        return vector<size_t>(rnk, dim);
+    }
+
+    // Nombre d'éléments de la forme dense
+    size_t size() const
+    {
+        size_t total = 1;
+        for (size_t k = 0; k < rnk; ++k) total *= dim;
+        return total;
+    }
+
+    // Nombre de composantes stockées
+    size_t n_components() const
+    {
+        return values.size();
+    }
+
+    const vector<T>& get_data() const
+    {
+        return values;
+    }
+
+    template<typename... Args>
+    T operator()(Args... args) const
+    {
+        int sign;
+        size_t pos = locate(sign, args...);
+        if (sign == 0) return T(0);
+        return sign > 0 ? values[pos] : tensor_packed::negate(values[pos]);
+    }
+
+    template<typename... Args>
+    tensor_packed::SignedReference<T> operator()(Args... args)
+    {
+        int sign;
+        size_t pos = locate(sign, args...);
+        return tensor_packed::SignedReference<T>(sign ? &values[pos] : nullptr, sign);
+    }
+
+    T at(const vector<size_t>& indices) const
+    {
+        int sign;
+        size_t pos = locate_indices(sign, indices);
+        if (sign == 0) return T(0);
+        return sign > 0 ? values[pos] : tensor_packed::negate(values[pos]);
+    }
+
+    /// f(indices triés, composante) sur chaque composante stockée
+    template<typename F>
+    void for_each_component(F f)
+    {
+        if (values.empty())
+            return;
+        vector<size_t> idx(rnk);
+        for (size_t k = 0; k < rnk; ++k)
+            idx[k] = S == Symmetry::Symmetric ? 0 : k;
+        do
+        {
+            f(static_cast<const vector<size_t>&>(idx), values[rank_of(idx.data())]);
+        } while (next_sorted(idx));
+    }
+
+    template<typename F>
+    void for_each_component(F f) const
+    {
+        const_cast<PackedTensor*>(this)->for_each_component([&](const vector<size_t>& idx, T& v)
+        {
+            f(idx, static_cast<const T&>(v));
+        });
+    }
+
+    /// Tenseur dense : chaque composante est recopiée sur toutes les permutations de ses indices
+    Tensor<T> to_tensor() const
+    {
+        Tensor<T> result(get_shape(), T(0));
+        for_each_component([&](const vector<size_t>& sorted, const T& v)
+        {
+            vector<size_t> perm = sorted;
+            do
+            {
+                // Signe : parité du nombre d'inversions
+                int sign = 1;
+                if (S == Symmetry::Antisymmetric)
+                    for (size_t i = 0; i < rnk; ++i)
+                        for (size_t j = i + 1; j < rnk; ++j)
+                            if (perm[i] > perm[j]) sign = -sign;
+                result.at(perm) = sign > 0 ? v : tensor_packed::negate(v);
+            } while (std::next_permutation(perm.begin(), perm.end()));
+        });
+        return result;
+    }
+
+    /// Contraction d'un axe avec un vecteur : (A.v)_{i1..i(r-1)} = sum_j A_{i1..i(r-1) j} v_j (axe axis pour j).
+    /// Le résultat garde la symétrie : chaque composante stockée contribue une fois par indice distinct,
+    /// soit ~C(n + r - 1, r) * r opérations au lieu de n^r.
+    PackedTensor contract_with(const Tensor<T>& v, size_t axis) const
+    {
+        if (rnk == 0 || axis >= rnk)
+            throw runtime_error("Invalid axis");
+        if (v.ndim() != 1 || v.get_shape()[0] != dim)
+            throw runtime_error("Dimension mismatch for contraction");
+
+        PackedTensor result(dim, rnk - 1, T(0));
+        const T* x = v.data();
+        vector<size_t> rest(rnk - 1);
+        // Antisymétrique : ramener j de l'axe axis à sa place p dans m coûte |p - axis| transpositions
+        for_each_component([&](const vector<size_t>& m, const T& a)
+        {
+            for (size_t p = 0; p < rnk; ++p)
+            {
+                if (S == Symmetry::Symmetric && p > 0 && m[p] == m[p - 1])
+                    continue;
+                for (size_t k = 0, o = 0; k < rnk; ++k)
+                    if (k != p) rest[o++] = m[k];
+                T term = a * x[m[p]];
+                T& dst = result.values[result.rank_of(rest.data())];
+                bool odd = S == Symmetry::Antisymmetric && (p + axis) % 2 == 1;
+                dst = odd ? dst + tensor_packed::negate(term) : dst + term;
+            }
+        });
+        return result;
+    }
+
+    PackedTensor operator+(const PackedTensor& other) const
+    {
+        check_same_layout(other);
+        PackedTensor result(*this);
+        for (size_t i = 0; i < values.size(); ++i)
+            result.values[i] = values[i] + other.values[i];
+        return result;
+    }
+
+    PackedTensor operator-(const PackedTensor& other) const
+    {
+        check_same_layout(other);
+        PackedTensor result(*this);
+        for (size_t i = 0; i < values.size(); ++i)
+            result.values[i] = values[i] + tensor_packed::negate(other.values[i]);
+        return result;
+    }
+
+    PackedTensor operator*(const T& s) const
+    {
+        PackedTensor result(*this);
+        for (T& v : result.values)
+            v = v * s;
+        return result;
+    }
+
+    friend PackedTensor operator*(const T& s, const PackedTensor& t)
+    {
+        PackedTensor result(t);
+        for (T& v : result.values)
+            v = s * v;
+        return result;
+    }
+
+    friend ostream& operator<<(ostream& os, const PackedTensor& t)
+    {
+        os << (S == Symmetry::Symmetric ? "SymmetricTensor" : "AntisymmetricTensor")
+           << " (rank: " << t.rnk << ", dim: " << t.dim << ", components: " << t.n_components() << "):\n";
+        t.for_each_component([&](const vector<size_t>& idx, const T& v)
+        {
+            os << "(";
+            for (size_t j = 0; j < idx.size(); ++j)
+            {
+                os << idx[j];
+                if (j != idx.size() - 1) os << ", ";
+            }
+            os << ") = " << v << "\n";
+        });
+        return os;
+    }
+
+private:
+    void check_same_layout(const PackedTensor& other) const
+    {
+        if (dim != other.dim || rnk != other.rnk)
+            throw runtime_error("Shape mismatch");
+    }
+};
+
+template<typename T>
+using SymmetricTensor = PackedTensor<T, Symmetry::Symmetric>;
+
+template<typename T>
+using AntisymmetricTensor = PackedTensor<T, Symmetry::Antisymmetric>;
+
+/// Métrique partagée depuis un tenseur symétrique de rang 2 (classée Symmetric / Diagonal / Identity)
+template<typename T>
+shared_ptr<const Metric<T>> make_metric(const SymmetricTensor<T>& g)
+{
+    if (g.ndim() != 2)
+        throw runtime_error("Metric must be a rank-2 tensor");
+    return make_metric(g.to_tensor());
+}
+
+/// Tenseur de type Riemann (rang 4) : R_abcd = -R_bacd = -R_abdc = R_cdab
+/// et R_abcd + R_acdb + R_adbc = 0 (première identité de Bianchi).
+/// n^2 (n^2 - 1) / 12 composantes indépendantes : 20 en 4D au lieu de 256.
+/// Stockage par paires antisymétriques (a < b) échangeables ; pour a < b < c < d,
+/// R_adbc = R_acbd - R_abcd n'est pas stockée mais calculée.
+template<typename T>
+class RiemannTensor
+{
+private:
+    static constexpr size_t NONE = size_t(-1);
+
+    size_t dim = 0;
+    vector<T> values;
+    vector<size_t> stored;                           // paire de paires -> composante stockée (NONE : Bianchi)
+    vector<std::pair<size_t, size_t>> bianchi;       // paire de paires (ad|bc) -> ((ac|bd), (ab|cd))
+    vector<std::array<size_t, 4>> representative;    // indices (a, b, c, d) de chaque composante stockée
+
+    size_t pair_index(size_t a, size_t b) const
+    {
+        return a * dim - a * (a + 1) / 2 + (b - a - 1);
+    }
+
+    static size_t slot(size_t P, size_t Q)
+    {
+        if (P > Q) std::swap(P, Q);
+        return Q * (Q + 1) / 2 + P;
+    }
+
+    // Paire de paires et signe des indices ; 0 si a == b ou c == d
+    int locate(size_t a, size_t b, size_t c, size_t d, size_t& s) const
+    {
+        if (a >= dim || b >= dim || c >= dim || d >= dim)
+            throw out_of_range("Index out of bounds");
+        if (a == b || c == d)
+            return 0;
+        int sign = 1;
+        if (a > b) { std::swap(a, b); sign = -sign; }
+        if (c > d) { std::swap(c, d); sign = -sign; }
+        s = slot(pair_index(a, b), pair_index(c, d));
+        return sign;
+    }
+
+    T read(size_t s) const
+    {
+        if (stored[s] != NONE)
+            return values[stored[s]];
+        return values[stored[bianchi[s].first]] + tensor_packed::negate(values[stored[bianchi[s].second]]);
+    }
+
+public:
+    /// Accès en écriture : R(a, b, c, d) = v ; une composante fixée par Bianchi ne s'écrit pas
+    class Reference
+    {
+        RiemannTensor* R;
+        size_t a, b, c, d;
+
+    public:
+        Reference(RiemannTensor* R_, size_t a_, size_t b_, size_t c_, size_t d_)
+            : R(R_), a(a_), b(b_), c(c_), d(d_)
+        {
+        }
+
+        operator T() const
+        {
+            return static_cast<const RiemannTensor&>(*R)(a, b, c, d);
+        }
+
+        Reference& operator=(const T& v)
+        {
+            R->set(a, b, c, d, v);
+            return *this;
+        }
+
+        Reference& operator=(const Reference& other)
+        {
+            return *this = static_cast<T>(other);
+        }
+    };
+
+    RiemannTensor() = default;
+
+    explicit RiemannTensor(size_t dim_, T init_val = T(0))
+        : dim(dim_)
+    {
+        size_t M = dim ? dim * (dim - 1) / 2 : 0;
+        stored.assign(M * (M + 1) / 2, NONE);
+        bianchi.assign(stored.size(), {NONE, NONE});
+
+        vector<std::array<size_t, 2>> pairs;
+        for (size_t a = 0; a < dim; ++a)
+            for (size_t b = a + 1; b < dim; ++b)
+                pairs.push_back({a, b});
+
+        for (size_t Q = 0; Q < M; ++Q)
+            for (size_t P = 0; P <= Q; ++P)
+            {
+                size_t a = pairs[P][0], b = pairs[P][1], c = pairs[Q][0], d = pairs[Q][1];
+                size_t s = slot(P, Q);
+                // (a d | b c) avec a < b < c < d, à une permutation des paires près
+                std::array<size_t, 4> q = {a, b, c, d};
+                std::sort(q.begin(), q.end());
+                bool distinct = q[0] < q[1] && q[1] < q[2] && q[2] < q[3];
+                if (distinct && s == slot(pair_index(q[0], q[3]), pair_index(q[1], q[2])))
+                {
+                    bianchi[s] = {slot(pair_index(q[0], q[2]), pair_index(q[1], q[3])),
+                                  slot(pair_index(q[0], q[1]), pair_index(q[2], q[3]))};
+                    continue;
+                }
+                stored[s] = representative.size();
+                representative.push_back({a, b, c, d});
+            }
+        values.assign(representative.size(), init_val);
+    }
+
+    /// Composantes indépendantes d'un tenseur dense n x n x n x n (supposé avoir les symétries de Riemann)
+    explicit RiemannTensor(const Tensor<T>& dense)
+    {
+        const vector<size_t>& shape = dense.get_shape();
+        if (shape.size() != 4 || shape[1] != shape[0] || shape[2] != shape[0] || shape[3] != shape[0])
+            throw runtime_error("Riemann tensor must be n x n x n x n");
+        *this = RiemannTensor(shape[0]);
+        for (size_t k = 0; k < values.size(); ++k)
+        {
+            const std::array<size_t, 4>& r = representative[k];
+            values[k] = dense(r[0], r[1], r[2], r[3]);
+        }
+    }
+
+    size_t get_dim() const
+    {
+        return dim;
+    }
+
+    size_t ndim() const
+    {
+        return 4;
+    }
+
+    vector<size_t> get_shape() const
+    {
+        return vector<size_t>(4, dim);
+    }
+
+    size_t n_components() const
+    {
+        return values.size();
+    }
+
+    T operator()(size_t a, size_t b, size_t c, size_t d) const
+    {
+        size_t s;
+        int sign = locate(a, b, c, d, s);
+        if (sign == 0) return T(0);
+        T v = read(s);
+        return sign > 0 ? v : tensor_packed::negate(v);
+    }
+
+    Reference operator()(size_t a, size_t b, size_t c, size_t d)
+    {
+        return Reference(this, a, b, c, d);
+    }
+
+    void set(size_t a, size_t b, size_t c, size_t d, const T& v)
+    {
+        size_t s;
+        int sign = locate(a, b, c, d, s);
+        if (sign == 0)
+        {
+            if (!tensor_packed::is_zero(v))
+                throw runtime_error("Riemann component with a repeated index in a pair is always zero");
+            return;
+        }
+        if (stored[s] == NONE)
+            throw runtime_error("Riemann component is fixed by the Bianchi identity (R_adbc = R_acbd - R_abcd)");
+        values[stored[s]] = sign > 0 ? v : tensor_packed::negate(v);
+    }
+
+    Tensor<T> to_tensor() const
+    {
+        Tensor<T> result(get_shape(), T(0));
+        for (size_t a = 0; a < dim; ++a)
+            for (size_t b = 0; b < dim; ++b)
+                for (size_t c = 0; c < dim; ++c)
+                    for (size_t d = 0; d < dim; ++d)
+                        result(a, b, c, d) = (*this)(a, b, c, d);
+        return result;
+    }
+
+    /// Tenseur de Ricci R_bd = g^ac R_abcd (symétrique : seules les composantes b <= d sont calculées)
+    SymmetricTensor<T> ricci(const Tensor<T>& g_inv) const
+    {
+        if (g_inv.get_shape() != vector<size_t>{dim, dim})
+            throw runtime_error("Dimension mismatch for contraction");
+        SymmetricTensor<T> result(dim, 2, T(0));
+        for (size_t b = 0; b < dim; ++b)
+            for (size_t d = b; d < dim; ++d)
+            {
+                T acc = T(0);
+                for (size_t a = 0; a < dim; ++a)
+                    for (size_t c = 0; c < dim; ++c)
+                        if (a != b && c != d)
+                            acc = acc + g_inv(a, c) * (*this)(a, b, c, d);
+                result(b, d) = acc;
+            }
+        return result;
+    }
+
+    /// Courbure scalaire R = g^bd R_bd
+    T ricci_scalar(const Tensor<T>& g_inv) const
+    {
+        SymmetricTensor<T> ric = ricci(g_inv);
+        T acc = T(0);
+        for (size_t b = 0; b < dim; ++b)
+            for (size_t d = 0; d < dim; ++d)
+                acc = acc + g_inv(b, d) * ric(b, d);
+        return acc;
+    }
+};
+
+#endif // TENSEURS_SYMMETRIC_H_INCLUDED
@@ -0,0 +1,419 @@
+///  -------------------------------------------------
+///  Benchmark de la classe Tensor
+///  Débit (Go/s) et calcul (GFLOP/s) des opérations de Tensor<T>,
+///  par taille, rang et type d'élément ; sortie JSON pour le suivi des régressions
+///  Coded by JP CHAMPEAUX
+///  contact : JPC@irsamc.upse-tlse.fr
+///  Free of use for Academic purpose only !
+///  (please, just mention author in your works if used or if your own code is inspired from it)
+///  --------------------------------------------------
+///
+///  tenseurs_bench [--quick] [--large] [--min-time s] [--threads n] [--filter op] [--json fichier]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Cout_color.h"
+#include "version.h"
+#include "Tenseurs.h"
+
+/// --------------------------------------------------------------------------------
+/// Mesure
+/// --------------------------------------------------------------------------------
+
+struct BenchOptions
+{
+    double min_time = 0.1;       // temps de mesure minimal par cas (s)
+    bool quick = false;          // tailles réduites, pour vérifier que tout tourne
+    bool large = false;          // ajoute les tenseurs de 2^24 éléments
+    size_t threads = 0;          // 0 : valeur par défaut du pool
+    string filter;               // seules les opérations dont le nom contient filter
+    string json_path;
+};
+
+struct BenchResult
+{
+    string op;
+    string type;
+    vector<size_t> shape;
+    size_t elements;     // éléments du résultat (ou de l'entrée pour une réduction)
+    size_t repeats;
+    double seconds;      // médiane
+    double best;         // minimum
+    double bytes;        // octets lus + écrits par appel (modèle)
+    double flops;        // opérations flottantes par appel
+
+    double gbps() const { return bytes / best * 1e-9; }
+    double gflops() const { return flops / best * 1e-9; }
+};
+
+// Empêche le compilateur de supprimer un résultat non utilisé
+static volatile double bench_sink = 0;
+
+template<typename T>
+inline void keep(const T& value)
+{
+    bench_sink = bench_sink + static_cast<double>(value);
+}
+
+template<typename T>
+inline void keep(const Tensor<T>& t)
+{
+    if (t.size())
+        keep(t.data()[t.size() - 1]);
+}
+
+template<typename F>
+BenchResult measure(F&& f, const BenchOptions& opt)
+{
+    using clock = std::chrono::steady_clock;
+    f();  // préchauffage : allocations, pages, threads du pool
+
+    vector<double> times;
+    auto start = clock::now();
+    do
+    {
+        auto t0 = clock::now();
+        f();
+        times.push_back(std::chrono::duration<double>(clock::now() - t0).count());
+    } while (times.size() < 3 || std::chrono::duration<double>(clock::now() - start).count() < opt.min_time);
+
+    BenchResult r{};
+    r.repeats = times.size();
+    std::sort(times.begin(), times.end());
+    r.seconds = times[times.size() / 2];
+    r.best = times.front();
+    return r;
+}
+
+template<typename T> const char* type_name();
+template<> const char* type_name<float>() { return "float"; }
+template<> const char* type_name<double>() { return "double"; }
+template<> const char* type_name<int>() { return "int"; }
+
+string shape_string(const vector<size_t>& shape)
+{
+    std::ostringstream os;
+    for (size_t i = 0; i < shape.size(); ++i)
+        os << (i ? "x" : "") << shape[i];
+    return os.str();
+}
+
+size_t product(const vector<size_t>& shape)
+{
+    size_t n = 1;
+    for (size_t d : shape)
+        n *= d;
+    return n;
+}
+
+template<typename T>
+Tensor<T> filled(const vector<size_t>& shape, size_t seed)
+{
+    Tensor<T> t(shape);
+    for (size_t i = 0; i < t.size(); ++i)
+        t.data()[i] = static_cast<T>(1 + (i * 7 + seed) % 13) / static_cast<T>(8);
+    return t;
+}
+
+/// --------------------------------------------------------------------------------
+/// Cas de mesure
+/// --------------------------------------------------------------------------------
+
+class Bench
+{
+    BenchOptions opt;
+    vector<BenchResult> results;
+
+    bool enabled(const string& op) const
+    {
+        return opt.filter.empty() || op.find(opt.filter) != string::npos;
+    }
+
+    template<typename F>
+    void run(const string& op, const char* type, const vector<size_t>& shape, size_t elements,
+             double bytes, double flops, F&& f)
+    {
+        if (!enabled(op))
+            return;
+        BenchResult r = measure(f, opt);
+        r.op = op;
+        r.type = type;
+        r.shape = shape;
+        r.elements = elements;
+        r.bytes = bytes;
+        r.flops = flops;
+        results.push_back(r);
+
+        cout << left << setw(16) << op << setw(8) << type << setw(18) << shape_string(shape)
+             << right << fixed << setprecision(3)
+             << setw(12) << r.best * 1e3 << " ms"
+             << green << setw(10) << setprecision(2) << r.gbps() << " GB/s" << white
+             << cyan << setw(10) << r.gflops() << " GFLOP/s" << white
+             << grey << "  (x" << r.repeats << ")" << white << endl;
+    }
+
+    // Formes de n éléments aux rangs 1, 2 et 4 (n puissance de 2, exposant multiple de 4)
+    static vector<vector<size_t>> shapes_for(size_t log2n)
+    {
+        return {
+            {size_t(1) << log2n},
+            {size_t(1) << (log2n / 2), size_t(1) << (log2n / 2)},
+            {size_t(1) << (log2n / 4), size_t(1) << (log2n / 4), size_t(1) << (log2n / 4), size_t(1) << (log2n / 4)}
+        };
+    }
+
+    vector<size_t> sizes() const
+    {
+        if (opt.quick)
+            return {12, 16};
+        if (opt.large)
+            return {12, 16, 20, 24};
+        return {12, 16, 20};
+    }
+
+    template<typename T>
+    void elementwise(const vector<size_t>& shape)
+    {
+        const char* type = type_name<T>();
+        const size_t n = product(shape);
+        const double s = sizeof(T);
+        Tensor<T> A = filled<T>(shape, 1), B = filled<T>(shape, 2);
+
+        run("add", type, shape, n, 3 * n * s, n, [&] { Tensor<T> C = A + B; keep(C); });
+        run("mul", type, shape, n, 3 * n * s, n, [&] { Tensor<T> C = A * B; keep(C); });
+        run("scale", type, shape, n, 2 * n * s, n, [&] { Tensor<T> C = A * T(3); keep(C); });
+        run("fused_axpy", type, shape, n, 3 * n * s, 2 * n, [&] { Tensor<T> C = A * T(3) + B; keep(C); });
+        run("add_inplace", type, shape, n, 3 * n * s, n, [&] { A += B; keep(A); });
+        run("sum", type, shape, n, n * s, n, [&] { keep(A.sum()); });
+        run("pseudo_norm", type, shape, n, n * s, 2 * n, [&] { keep(A.pseudo_norm()); });
+
+        // Moitié du premier axe, copiée
+        vector<size_t> half = shape;
+        half[0] /= 2;
+        const size_t nh = product(half);
+        run("slice", type, half, nh, 2 * nh * s, 0, [&]
+        {
+            Tensor<T> C = A.slice({std::make_tuple(size_t(0), size_t(0), shape[0] / 2)});
+            keep(C);
+        });
+
+        if (shape.size() > 1)
+        {
+            vector<size_t> order(shape.size());
+            for (size_t k = 0; k < order.size(); ++k)
+                order[k] = order.size() - 1 - k;
+            vector<size_t> reversed(shape.rbegin(), shape.rend());
+            run("permute", type, reversed, n, 2 * n * s, 0, [&] { Tensor<T> C = A.permute(order); keep(C); });
+
+            // Trace sur les deux premiers axes
+            vector<size_t> rest(shape.begin() + 2, shape.end());
+            size_t nr = product(rest), d = shape[0];
+            run("contract", type, shape, n, (d + 1) * nr * s, d * nr, [&] { Tensor<T> C = A.contract(0, 1); keep(C); });
+        }
+
+        // Produit de Kronecker dont le résultat a la forme shape
+        vector<size_t> shape_a(shape.size()), shape_b(shape.size());
+        for (size_t k = 0; k < shape.size(); ++k)
+        {
+            size_t log2d = 0;
+            while ((size_t(1) << (log2d + 1)) <= shape[k])
+                ++log2d;
+            shape_a[k] = size_t(1) << (log2d / 2);
+            shape_b[k] = shape[k] / shape_a[k];
+        }
+        Tensor<T> Ka = filled<T>(shape_a, 3), Kb = filled<T>(shape_b, 4);
+        const size_t na = product(shape_a), nb = product(shape_b);
+        run("tensor_product", type, shape, n, (n + na + nb) * s, n, [&] { Tensor<T> C = Ka.tensor_product(Kb); keep(C); });
+    }
+
+    // A(..., k) B(k, ...) : rang 2 (matrices), rang 3 et rang 4, dimensions égales
+    template<typename T>
+    void contractions()
+    {
+        const char* type = type_name<T>();
+        const double s = sizeof(T);
+        vector<pair<size_t, size_t>> cases;  // (rang, dimension)
+        if (opt.quick)
+            cases = {{2, 64}, {2, 256}, {3, 16}, {4, 8}};
+        else
+            cases = {{2, 64}, {2, 256}, {2, 1024}, {3, 16}, {3, 32}, {4, 8}, {4, 12}};
+
+        for (const auto& c : cases)
+        {
+            size_t rank = c.first, d = c.second;
+            vector<size_t> shape(rank, d);
+            Tensor<T> A = filled<T>(shape, 5), B = filled<T>(shape, 6);
+            double in = static_cast<double>(product(shape));
+            double out = in / d * in / d;
+            run("contract_with", type, shape, static_cast<size_t>(out), (2 * in + out) * s, 2 * out * d, [&]
+            {
+                Tensor<T> C = A.contract_with(B, rank - 1, 0);
+                keep(C);
+            });
+        }
+    }
+
+    // Lots de quadrivecteurs {N, 4} : pseudo-normes de Minkowski, matrice 4x4 partagée,
+    // contraction d'une matrice 4x4 propre à chaque élément
+    template<typename T>
+    void batched()
+    {
+        const char* type = type_name<T>();
+        const double s = sizeof(T);
+        for (size_t log2n : sizes())
+        {
+            const size_t n = (size_t(1) << log2n) / 4;
+            Tensor<T> P = filled<T>({n, 4}, 7), L = filled<T>({4, 4}, 8), Lb = filled<T>({n, 4, 4}, 9);
+            Tensor<T> eta({4, 4});
+            eta.fill(T(0));
+            for (size_t k = 0; k < 4; ++k)
+                eta(k, k) = k ? T(-1) : T(1);
+            P.set_metric(eta);
+
+            run("batch_pnorm", type, {n, 4}, n, 5 * n * s, 12 * n, [&] { Tensor<T> C = P.batched_pseudo_norm(); keep(C); });
+            run("batch_matvec", type, {n, 4}, 4 * n, 8 * n * s, 32 * n, [&] { Tensor<T> C = P.batched_matvec(L); keep(C); });
+            run("batch_contract", type, {n, 4, 4}, 4 * n, 24 * n * s, 32 * n, [&] { Tensor<T> C = Lb.batched_contract_with(P, 1, 0); keep(C); });
+        }
+    }
+
+    template<typename T>
+    void all_types_pass()
+    {
+        for (size_t log2n : sizes())
+            for (const vector<size_t>& shape : shapes_for(log2n))
+                elementwise<T>(shape);
+        contractions<T>();
+        batched<T>();
+    }
+
+public:
+    explicit Bench(const BenchOptions& o)
+        : opt(o)
+    {
+    }
+
+    void run_all()
+    {
+        cout << yellow << left << setw(16) << "operation" << setw(8) << "type" << setw(18) << "shape"
+             << right << setw(15) << "best" << setw(15) << "throughput" << setw(18) << "compute" << white << endl;
+        all_types_pass<float>();
+        all_types_pass<double>();
+        all_types_pass<int>();
+    }
+
+    void write_json(const string& path) const
+    {
+        std::ofstream os(path);
+        if (!os)
+            throw runtime_error("Cannot open " + path);
+
+        os << std::setprecision(9);
+        os << "{\n";
+        os << "  \"library\": \"Tenseurs\",\n";
+        os << "  \"version\": \"" << AutoVersion::FULLVERSION_STRING << "\",\n";
+#ifdef __VERSION__
+        os << "  \"compiler\": \"" << __VERSION__ << "\",\n";
+#endif
+        os << "  \"simd\": \"" << tensor_kernels::simd<double>().name << "\",\n";
+        os << "  \"threads\": " << tensor_kernels::num_threads() << ",\n";
+        os << "  \"timestamp\": " << static_cast<long long>(time(nullptr)) << ",\n";
+        os << "  \"results\": [\n";
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const BenchResult& r = results[i];
+            os << "    {\"op\": \"" << r.op << "\", \"type\": \"" << r.type << "\", \"shape\": [";
+            for (size_t k = 0; k < r.shape.size(); ++k)
+                os << (k ? ", " : "") << r.shape[k];
+            os << "], \"rank\": " << r.shape.size()
+               << ", \"elements\": " << r.elements
+               << ", \"repeats\": " << r.repeats
+               << ", \"median_s\": " << r.seconds
+               << ", \"best_s\": " << r.best
+               << ", \"bytes\": " << r.bytes
+               << ", \"flops\": " << r.flops
+               << ", \"gbps\": " << r.gbps()
+               << ", \"gflops\": " << r.gflops() << "}"
+               << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        os << "  ]\n}\n";
+    }
+};
+
+/// --------------------------------------------------------------------------------
+
+static void usage()
+{
+    cout << "tenseurs_bench [--quick] [--large] [--min-time s] [--threads n] [--filter op] [--json file]\n"
+         << "  --quick      small sizes, short timing (smoke run)\n"
+         << "  --large      also run 2^24-element tensors\n"
+         << "  --min-time   minimal timing per case in seconds (default 0.1)\n"
+         << "  --threads    size of the thread pool\n"
+         << "  --filter     only operations whose name contains op\n"
+         << "  --json       write the results to file\n";
+}
+
+int main(int argc, char** argv)
+{
+    BenchOptions opt;
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        auto value = [&]() -> string
+        {
+            if (i + 1 >= argc)
+            {
+                cerr << "Missing value after " << arg << endl;
+                exit(2);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--quick")
+        {
+            opt.quick = true;
+            opt.min_time = 0.02;
+        }
+        else if (arg == "--large")
+            opt.large = true;
+        else if (arg == "--min-time")
+            opt.min_time = std::atof(value().c_str());
+        else if (arg == "--threads")
+            opt.threads = std::strtoul(value().c_str(), nullptr, 10);
+        else if (arg == "--filter")
+            opt.filter = value();
+        else if (arg == "--json")
+            opt.json_path = value();
+        else
+        {
+            usage();
+            return arg == "--help" || arg == "-h" ? 0 : 2;
+        }
+    }
+
+    if (opt.threads)
+        tensor_kernels::set_num_threads(opt.threads);
+
+    cout << blue << "Tensor Class C++ benchmark " << white << AutoVersion::FULLVERSION_STRING
+         << grey << "  (simd: " << tensor_kernels::simd<double>().name
+         << ", threads: " << tensor_kernels::num_threads() << ")" << white << endl;
+
+    Bench bench(opt);
+    bench.run_all();
+
+    if (!opt.json_path.empty())
+    {
+        bench.write_json(opt.json_path);
+        cout << green << "Results written to " << opt.json_path << white << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,1115 @@
+///  -------------------------------------------------
+///  Tests de la classe Tensor
+///  Chaque opération est comparée à une référence dense ou naïve
+///  Coded by JP CHAMPEAUX
+///  contact : JPC@irsamc.upse-tlse.fr
+///  Free of use for Academic purpose only !
+///  (please, just mention author in your works if used or if your own code is inspired from it)
+///  --------------------------------------------------
+///
+///  tenseurs_tests [filtre]   (code de retour : nombre d'échecs)
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Tenseurs.h"
+#include "Tenseurs_chunked.h"
+#include "Tenseurs_sparse.h"
+#include "Tenseurs_symbolic.h"
+#include "Tenseurs_symmetric.h"
+
+/// --------------------------------------------------------------------------------
+/// Outils
+/// --------------------------------------------------------------------------------
+
+static int failures = 0;
+static int checks = 0;
+static string current_test;
+
+static void check(bool ok, const string& what)
+{
+    ++checks;
+    if (!ok)
+    {
+        ++failures;
+        cout << "  FAIL [" << current_test << "] " << what << endl;
+    }
+}
+
+static std::mt19937 rng(12345);
+
+// Valeurs aléatoires dans [-1, 1] ; avec density < 1, une partie des éléments est nulle
+static Tensor<double> random_tensor(const vector<size_t>& shape, double density = 1.0)
+{
+    std::uniform_real_distribution<double> value(-1.0, 1.0), keep(0.0, 1.0);
+    Tensor<double> t(shape);
+    for (size_t i = 0; i < t.size(); ++i)
+        t.data()[i] = keep(rng) < density ? value(rng) : 0.0;
+    return t;
+}
+
+static double max_diff(const Tensor<double>& a, const Tensor<double>& b)
+{
+    if (a.get_shape() != b.get_shape())
+        return INFINITY;
+    double d = 0;
+    for (size_t i = 0; i < a.size(); ++i)
+        d = std::max(d, std::abs(a.data()[i] - b.data()[i]));
+    return d;
+}
+
+static void check_close(const Tensor<double>& got, const Tensor<double>& expected, const string& what, double tol = 1e-10)
+{
+    double d = max_diff(got, expected);
+    check(d <= tol, what + " (max |diff| = " + std::to_string(d) + ")");
+}
+
+// diag(-1, 1, ..., 1)
+static Tensor<double> diagonal_metric(size_t n)
+{
+    Tensor<double> g({n, n});
+    g.fill(0.0);
+    for (size_t k = 0; k < n; ++k)
+        g(k, k) = k ? 1.0 : -1.0;
+    return g;
+}
+
+// Scalaire générique minimal, comme Symbole : seulement + et * (ni +=, ni construction depuis 0)
+struct Plain
+{
+    double v;
+    Plain operator+(const Plain& o) const { return {v + o.v}; }
+    Plain operator*(const Plain& o) const { return {v * o.v}; }
+};
+
+static Tensor<Plain> to_plain(const Tensor<double>& t)
+{
+    Tensor<Plain> p(t.get_shape());
+    for (size_t i = 0; i < t.size(); ++i)
+        p.data()[i] = {t.data()[i]};
+    return p;
+}
+
+static Tensor<double> from_plain(const Tensor<Plain>& p)
+{
+    Tensor<double> t(p.get_shape());
+    for (size_t i = 0; i < p.size(); ++i)
+        t.data()[i] = p.data()[i].v;
+    return t;
+}
+
+/// --------------------------------------------------------------------------------
+/// Expressions : broadcasting, opérateurs composés en place, affectation avec changement de forme
+/// --------------------------------------------------------------------------------
+
+// Élément de t lu à l'indice idx de la forme cible (alignement à droite, dimension 1 répétée)
+static double broadcast_at(const Tensor<double>& t, const vector<size_t>& idx)
+{
+    const vector<size_t>& shape = t.get_shape();
+    size_t flat = 0;
+    for (size_t d = 0; d < shape.size(); ++d)
+        flat = flat * shape[d] + (shape[d] == 1 ? 0 : idx[idx.size() - shape.size() + d]);
+    return t.data()[flat];
+}
+
+// op(a, b) élément par élément sur la forme shape
+template<typename Op>
+static Tensor<double> naive_broadcast(const Tensor<double>& a, const Tensor<double>& b, const vector<size_t>& shape, Op op)
+{
+    Tensor<double> r(shape);
+    vector<size_t> idx(shape.size(), 0);
+    for (size_t i = 0; i < r.size(); ++i)
+    {
+        r.data()[i] = op(broadcast_at(a, idx), broadcast_at(b, idx));
+        for (size_t d = idx.size(); d-- > 0;)
+        {
+            if (++idx[d] < shape[d])
+                break;
+            idx[d] = 0;
+        }
+    }
+    return r;
+}
+
+static bool throws(const std::function<void()>& f)
+{
+    try
+    {
+        f();
+    }
+    catch (const runtime_error&)
+    {
+        return true;
+    }
+    return false;
+}
+
+static void test_broadcast()
+{
+    auto plus = [](double x, double y) { return x + y; };
+    auto minus = [](double x, double y) { return x - y; };
+    auto times = [](double x, double y) { return x * y; };
+    auto divide = [](double x, double y) { return x / y; };
+
+    Tensor<double> A = random_tensor({2, 3}), row = random_tensor({3}), column = random_tensor({3, 1}), line = random_tensor({1, 4});
+    Tensor<double> scalar(vector<size_t>{}, 1.5);
+
+    check_close(Tensor<double>(A + row), naive_broadcast(A, row, {2, 3}, plus), "{2, 3} + {3}");
+    check_close(Tensor<double>(row + A), naive_broadcast(row, A, {2, 3}, plus), "{3} + {2, 3}");
+    check_close(Tensor<double>(column * line), naive_broadcast(column, line, {3, 4}, times), "{3, 1} * {1, 4}");
+    check_close(Tensor<double>(A - scalar), naive_broadcast(A, scalar, {2, 3}, minus), "{2, 3} - rank 0");
+    check_close(Tensor<double>(scalar * column), naive_broadcast(scalar, column, {3, 1}, times), "rank 0 * {3, 1}");
+    check(Tensor<double>(scalar + scalar).get_shape().empty(), "rank 0 + rank 0 has rank 0");
+    check_close(Tensor<double>(A * 2.0 + row), naive_broadcast(naive_broadcast(A, scalar, {2, 3}, [](double x, double) { return 2.0 * x; }), row, {2, 3}, plus),
+                "A * 2.0 + {3}");
+    check_close(Tensor<double>((column * line) / (line * 3.0 + scalar)),
+                naive_broadcast(naive_broadcast(column, line, {3, 4}, times), naive_broadcast(line, scalar, {1, 4}, [](double x, double y) { return 3.0 * x + y; }), {3, 4}, divide),
+                "nested broadcasts");
+    check(throws([&] { Tensor<double> bad = A + random_tensor({2}); }), "{2, 3} + {2} throws");
+    check(throws([&] { Tensor<double> bad = A * column; }), "{2, 3} * {3, 1} throws");
+
+    // Opérateurs composés : l'opérande est diffusé sur la forme de A, qui ne change pas
+    const vector<std::pair<string, std::function<double(double, double)>>> ops = {{"+=", plus}, {"-=", minus}, {"*=", times}, {"/=", divide}};
+    for (const auto& op : ops)
+    {
+        for (const Tensor<double>* rhs : {&row, &scalar})
+        {
+            Tensor<double> B = A;
+            const double* before = B.data();
+            if (op.first == "+=") B += *rhs;
+            if (op.first == "-=") B -= *rhs;
+            if (op.first == "*=") B *= *rhs;
+            if (op.first == "/=") B /= *rhs;
+            string what = "A " + op.first + (rhs == &row ? " {3}" : " rank 0");
+            check_close(B, naive_broadcast(A, *rhs, {2, 3}, op.second), what);
+            check(B.data() == before, what + " in place");
+        }
+    }
+    Tensor<double> C = A;
+    C += row * 2.0 - scalar;
+    check_close(C, naive_broadcast(A, naive_broadcast(row, scalar, {3}, [](double x, double y) { return 2.0 * x - y; }), {2, 3}, plus), "A += broadcast expression");
+    check(throws([&] { Tensor<double> B = A; B += random_tensor({2}); }), "A += {2} throws");
+    check(throws([&] { Tensor<double> B = A; B += column; }), "A += {3, 1} throws");
+    check(throws([&] { Tensor<double> B = row; B *= A; }), "{3} *= {2, 3} throws (would change the shape)");
+
+    // A = expr : même nombre d'éléments, autre forme ; le buffer est réutilisé
+    Tensor<double> D = A, E = random_tensor({3, 2});
+    const double* before = D.data();
+    D = E * 2.0 + scalar;
+    check(D.get_shape() == vector<size_t>{3, 2}, "{2, 3} <- {3, 2}: shape");
+    check(D.data() == before, "{2, 3} <- {3, 2}: buffer reused");
+    check_close(D, naive_broadcast(E, scalar, {3, 2}, [](double x, double y) { return 2.0 * x + y; }), "{2, 3} <- {3, 2}: values");
+    check(D(2, 1) == E(2, 1) * 2.0 + 1.5, "{2, 3} <- {3, 2}: strides");
+    Tensor<double> F = row;
+    F = F + Tensor<double>({1, 3}, 0.5);
+    check(F.get_shape() == vector<size_t>{1, 3}, "{3} <- {3} + {1, 3}: shape");
+    check_close(F, naive_broadcast(row, scalar, {1, 3}, [](double x, double) { return x + 0.5; }), "{3} <- {3} + {1, 3}: values");
+    Tensor<double> G = A;
+    G = column * line;
+    check_close(G, naive_broadcast(column, line, {3, 4}, times), "{2, 3} <- {3, 4}: reallocated");
+}
+
+/// --------------------------------------------------------------------------------
+/// Allocateurs : alignement 64 octets, copie arène <-> standard, réutilisation des blocs après reset()
+/// --------------------------------------------------------------------------------
+
+static bool aligned_64(const void* p)
+{
+    return reinterpret_cast<std::uintptr_t>(p) % 64 == 0;
+}
+
+static void test_alloc()
+{
+    for (size_t n : {1, 3, 17, 1000})
+    {
+        Tensor<double> d({n});
+        Tensor<float> f({n, 3});
+        check(aligned_64(d.data()), "Tensor<double> aligned, n = " + std::to_string(n));
+        check(aligned_64(f.data()), "Tensor<float> aligned, n = " + std::to_string(n));
+    }
+
+    TensorArena& arena = TensorArena::local();
+    arena.reset();
+    {
+        // Tensor<double> -> arène -> Tensor<double> : valeurs, forme et métrique conservées
+        Tensor<double> A = random_tensor({4, 5});
+        A.set_metric(diagonal_metric(5));
+        Tensor<double, ArenaAllocator<double>> in_arena(A);
+        check(in_arena.get_shape() == A.get_shape(), "arena copy: shape");
+        check(std::equal(A.data(), A.data() + A.size(), in_arena.data()), "arena copy: values");
+        check(in_arena.get_shared_metric() == A.get_shared_metric(), "arena copy: metric shared");
+        check(aligned_64(in_arena.data()), "arena tensor aligned");
+
+        in_arena *= 2.0;
+        Tensor<double> back(in_arena);
+        check_close(back, Tensor<double>(A * 2.0), "arena -> Tensor<double>");
+        check(back.data() != in_arena.data(), "arena -> Tensor<double>: own buffer");
+        check(back.get_shared_metric() == A.get_shared_metric(), "arena -> Tensor<double>: metric shared");
+    }
+
+    // reset() : les allocations suivantes reprennent au début du même bloc, sans nouvelle réservation
+    arena.reset();
+    const double* first;
+    {
+        Tensor<double, ArenaAllocator<double>> a({100}), b({100});
+        first = a.data();
+        check(b.data() >= first + 100, "arena: consecutive allocations do not overlap");
+    }
+    size_t capacity = arena.capacity();
+    arena.reset();
+    {
+        Tensor<double, ArenaAllocator<double>> a({100});
+        check(a.data() == first, "arena: reset() reuses the first block");
+    }
+    check(arena.capacity() == capacity, "arena: reset() keeps the blocks");
+
+    // Au-delà du premier bloc, un bloc plus grand est ajouté ; après reset() le premier sert de nouveau
+    TensorArena own;
+    void* p = own.allocate(100);
+    void* q = own.allocate(100);
+    check(static_cast<char*>(q) - static_cast<char*>(p) == 128, "arena: sizes rounded to 64 bytes");
+    void* big = own.allocate(size_t(3) << 20);
+    check(aligned_64(big) && big != p, "arena: large request in a new block");
+    size_t own_capacity = own.capacity();
+    own.reset();
+    check(own.allocate(100) == p, "arena: first block reused after reset()");
+    check(own.allocate(size_t(3) << 20) == big, "arena: large block reused after reset()");
+    check(own.capacity() == own_capacity, "arena: no new block after reset()");
+    arena.reset();
+}
+
+/// --------------------------------------------------------------------------------
+/// SparseTensor : fusion CSF (+, -, *) et contractions contre le calcul dense
+/// --------------------------------------------------------------------------------
+
+static void test_sparse()
+{
+    for (double density : {0.05, 0.3, 1.0})
+    {
+        string d = " density " + std::to_string(density);
+        Tensor<double> A = random_tensor({5, 4, 6}, density), B = random_tensor({5, 4, 6}, density);
+        SparseTensor<double> sA(A), sB(B);
+
+        check_close(sA.to_tensor(), A, "round trip" + d);
+        check_close((sA + sB).to_tensor(), Tensor<double>(A + B), "a + b" + d);
+        check_close((sA - sB).to_tensor(), Tensor<double>(A - B), "a - b" + d);
+        check_close((sA * sB).to_tensor(), Tensor<double>(A * B), "a * b" + d);
+        check_close((sA * 2.5).to_tensor(), Tensor<double>(A * 2.5), "a * s" + d);
+
+        Tensor<double> S = random_tensor({5, 5, 3}, density);
+        SparseTensor<double> sS(S);
+        check_close(sS.contract(0, 1).to_tensor(), S.contract(0, 1), "contract(0, 1)" + d);
+
+        Tensor<double> C = random_tensor({6, 3}, density);
+        SparseTensor<double> sC(C);
+        check_close(sA.contract_with(sC, 2, 0).to_tensor(), A.contract_with(C, 2, 0), "sparse x sparse" + d);
+        check_close(sA.contract_with(C, 2, 0), A.contract_with(C, 2, 0), "sparse x dense" + d);
+        check_close(sA.contract_with(sB, 0, 0).to_tensor(), A.contract_with(B, 0, 0), "leading axes" + d);
+    }
+}
+
+/// --------------------------------------------------------------------------------
+/// Tenseurs compacts : signes antisymétriques, contraction, emplacements Riemann / Bianchi
+/// --------------------------------------------------------------------------------
+
+static void test_packed()
+{
+    const size_t n = 5;
+
+    // Antisymétrique de rang 3 : T_ijk = sign(permutation) T_sorted, nul si deux indices égaux
+    AntisymmetricTensor<double> A(n, 3, 0.0);
+    std::uniform_real_distribution<double> value(-1.0, 1.0);
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = i + 1; j < n; ++j)
+            for (size_t k = j + 1; k < n; ++k)
+                A(i, j, k) = value(rng);
+    Tensor<double> D = A.to_tensor();
+    bool signs = true;
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < n; ++j)
+            for (size_t k = 0; k < n; ++k)
+            {
+                double v = D(i, j, k);
+                signs = signs && v == -D(j, i, k) && v == -D(i, k, j) && v == D(j, k, i) && v == A(i, j, k);
+                if (i == j || j == k || i == k)
+                    signs = signs && v == 0.0;
+            }
+    check(signs, "antisymmetric signs");
+    check(A.n_components() == n * (n - 1) * (n - 2) / 6, "antisymmetric components");
+
+    // Écriture par un indice non trié : la composante stockée prend le signe de la permutation
+    A(3, 1, 0) = 2.0;
+    check(A(0, 1, 3) == -2.0 && A(1, 3, 0) == -2.0 && A(3, 0, 1) == -2.0, "antisymmetric write through permutation");
+    D = A.to_tensor();
+
+    Tensor<double> v = random_tensor({n});
+    for (size_t axis = 0; axis < 3; ++axis)
+        check_close(A.contract_with(v, axis).to_tensor(), D.contract_with(v, axis, 0), "antisymmetric contract axis " + std::to_string(axis));
+
+    // Symétrique de rang 3 : tenseur dense symétrisé
+    Tensor<double> R = random_tensor({n, n, n}), Sd({n, n, n});
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < n; ++j)
+            for (size_t k = 0; k < n; ++k)
+                Sd(i, j, k) = R(i, j, k) + R(i, k, j) + R(j, i, k) + R(j, k, i) + R(k, i, j) + R(k, j, i);
+    SymmetricTensor<double> S(Sd);
+    check(S.n_components() == n * (n + 1) * (n + 2) / 6, "symmetric components");
+    check_close(S.to_tensor(), Sd, "symmetric round trip");
+    for (size_t axis = 0; axis < 3; ++axis)
+        check_close(S.contract_with(v, axis).to_tensor(), Sd.contract_with(v, axis, 0), "symmetric contract axis " + std::to_string(axis));
+}
+
+// R_abcd = P_ac Q_bd + Q_ac P_bd - P_ad Q_bc - Q_ad P_bc (P, Q symétriques) a toutes les symétries de Riemann
+static Tensor<double> riemann_reference(size_t n)
+{
+    Tensor<double> P = random_tensor({n, n}), Q = random_tensor({n, n});
+    Tensor<double> Ps({n, n}), Qs({n, n}), R({n, n, n, n});
+    for (size_t a = 0; a < n; ++a)
+        for (size_t b = 0; b < n; ++b)
+        {
+            Ps(a, b) = P(a, b) + P(b, a);
+            Qs(a, b) = Q(a, b) + Q(b, a);
+        }
+    for (size_t a = 0; a < n; ++a)
+        for (size_t b = 0; b < n; ++b)
+            for (size_t c = 0; c < n; ++c)
+                for (size_t d = 0; d < n; ++d)
+                    R(a, b, c, d) = Ps(a, c) * Qs(b, d) + Qs(a, c) * Ps(b, d) - Ps(a, d) * Qs(b, c) - Qs(a, d) * Ps(b, c);
+    return R;
+}
+
+static void test_riemann()
+{
+    for (size_t n : {2, 3, 4, 5})
+    {
+        string d = " n = " + std::to_string(n);
+        Tensor<double> R = riemann_reference(n);
+        RiemannTensor<double> r(R);
+        check(r.n_components() == n * n * (n * n - 1) / 12, "independent components" + d);
+        check_close(r.to_tensor(), R, "round trip" + d);
+
+        // Lecture de chaque emplacement, composantes Bianchi comprises
+        bool slots = true;
+        for (size_t a = 0; a < n; ++a)
+            for (size_t b = 0; b < n; ++b)
+                for (size_t c = 0; c < n; ++c)
+                    for (size_t e = 0; e < n; ++e)
+                        slots = slots && std::abs(r(a, b, c, e) - R(a, b, c, e)) < 1e-12;
+        check(slots, "component access" + d);
+
+        // Écriture composante par composante d'un tenseur vide ; R_adbc (a < b < c < d) est refusée,
+        // elle est déduite des deux autres par l'identité de Bianchi
+        RiemannTensor<double> w(n);
+        size_t refused = 0;
+        for (size_t a = 0; a < n; ++a)
+            for (size_t b = a + 1; b < n; ++b)
+                for (size_t c = 0; c < n; ++c)
+                    for (size_t e = c + 1; e < n; ++e)
+                        try
+                        {
+                            w.set(a, b, c, e, R(a, b, c, e));
+                        }
+                        catch (const runtime_error&)
+                        {
+                            ++refused;
+                        }
+        check_close(w.to_tensor(), R, "set and read back" + d);
+        check(refused == 2 * (n * (n - 1) * (n - 2) * (n - 3) / 24), "Bianchi slots refused" + d);  // (ad|bc) et (bc|ad)
+    }
+}
+
+/// --------------------------------------------------------------------------------
+/// SymbolicKernel : registres réutilisés, blocs de 64 points et tuiles de sortie
+/// --------------------------------------------------------------------------------
+
+static void test_symbolic()
+{
+    Symbol x("x"), y("y"), z("z");
+    Symbol shared = x * y + z;
+
+    // Plus de composantes qu'une tuile de sortie, expressions partagées entre composantes
+    const size_t n_comp = 300;
+    Tensor<Symbol> E({n_comp});
+    for (size_t i = 0; i < n_comp; ++i)
+    {
+        double c = double(i % 7) - 3.0;
+        switch (i % 6)
+        {
+        case 0: E(i) = shared * c + 1; break;
+        case 1: E(i) = x - y * c; break;
+        case 2: E(i) = (x + 2) / (y * y + 1); break;
+        case 3: E(i) = pow(shared, int(i % 4)) - z; break;
+        case 4: E(i) = -(x * z) + shared * shared; break;
+        default: E(i) = Symbol(c); break;
+        }
+    }
+
+    SymbolicKernel k(E, {"x", "y", "z"});
+    for (size_t N : {1, 63, 64, 65, 300})
+    {
+        Tensor<double> points = random_tensor({N, 3});
+        Tensor<double> values = k.evaluate(points);
+        Tensor<double> expected({N, n_comp});
+        for (size_t p = 0; p < N; ++p)
+        {
+            std::unordered_map<string, double> at = {{"x", points(p, 0)}, {"y", points(p, 1)}, {"z", points(p, 2)}};
+            for (size_t i = 0; i < n_comp; ++i)
+                expected(p, i) = E(i).evaluate(at);
+        }
+        check_close(values, expected, "kernel vs Symbol::evaluate, " + std::to_string(N) + " points", 1e-9);
+    }
+
+    // Contraction symbolique compilée
+    Tensor<Symbol> A({3, 3});
+    for (size_t i = 0; i < 3; ++i)
+        for (size_t j = 0; j < 3; ++j)
+            A(i, j) = (i == j) ? x : Symbol(double(i) - double(j)) * y;
+    Tensor<Symbol> C = A.contract_with(A, 1, 0);
+    SymbolicKernel kc(C, {"x", "y"});
+    Tensor<double> one({2});
+    one(0) = 0.7;
+    one(1) = -1.3;
+    Tensor<double> An({3, 3});
+    for (size_t i = 0; i < 3; ++i)
+        for (size_t j = 0; j < 3; ++j)
+            An(i, j) = (i == j) ? 0.7 : (double(i) - double(j)) * -1.3;
+    check_close(kc.evaluate(one), An.contract_with(An, 1, 0), "compiled contraction", 1e-12);
+}
+
+/// --------------------------------------------------------------------------------
+/// ChunkedTensor : traitement par tuiles avec un petit budget contre le calcul en mémoire
+/// --------------------------------------------------------------------------------
+
+static void test_chunked()
+{
+    const string a_path = "tenseurs_test_a.tns", b_path = "tenseurs_test_b.tns", out_path = "tenseurs_test_out.tns";
+    const size_t budget = 2048;  // quelques lignes par tuile
+
+    Tensor<double> A = random_tensor({50, 6}), B = random_tensor({50, 4}), M = random_tensor({6, 3});
+    ChunkedTensor<double> cA = ChunkedTensor<double>::from_tensor(a_path, A, budget);
+    ChunkedTensor<double> cB = ChunkedTensor<double>::from_tensor(b_path, B, budget);
+    check(cA.rows_per_tile() < 50, "several tiles");
+
+    check_close(cA.to_tensor(), A, "round trip");
+    check(std::abs(cA.sum() - A.sum()) < 1e-10, "sum");
+    check_close(cA.map(out_path, [](const Tensor<double>& t) { return Tensor<double>(t * 2.0 + t); }).to_tensor(),
+                Tensor<double>(A * 3.0), "map");
+    check_close(cA.contract_with(M, 1, 0, out_path).to_tensor(), A.contract_with(M, 1, 0), "contract_with");
+    check_close(cA.contract_leading(cB), A.contract_with(B, 0, 0), "contract_leading (chunked)");
+    check_close(cA.contract_leading(B, 0), A.contract_with(B, 0, 0), "contract_leading (in memory)");
+
+    // Métrique lue dans le fichier : sur l'axe contracté (6), puis sur le premier axe (50)
+    Tensor<double> Ag = A;
+    Ag.set_metric(diagonal_metric(6));
+    ChunkedTensor<double> cAg = ChunkedTensor<double>::from_tensor(a_path, Ag, budget);
+    check_close(cAg.contract_with(M, 1, 0, out_path).to_tensor(), Ag.contract_with(M, 1, 0), "contract_with, diagonal metric");
+    Tensor<double> G = random_tensor({6, 6});
+    Ag.set_metric(G);
+    cAg = ChunkedTensor<double>::from_tensor(a_path, Ag, budget);
+    check_close(cAg.contract_with(M, 1, 0, out_path).to_tensor(), Ag.contract_with(M, 1, 0), "contract_with, dense metric");
+
+    Ag.set_metric(diagonal_metric(50));
+    cAg = ChunkedTensor<double>::from_tensor(a_path, Ag, budget);
+    check_close(cAg.contract_leading(cB), Ag.contract_with(B, 0, 0), "contract_leading (chunked), diagonal metric");
+    check_close(cAg.contract_leading(B, 0), Ag.contract_with(B, 0, 0), "contract_leading (in memory), diagonal metric");
+    Ag.set_metric(random_tensor({50, 50}));
+    cAg = ChunkedTensor<double>::from_tensor(a_path, Ag, budget);
+    check_close(cAg.contract_leading(B, 0), Ag.contract_with(B, 0, 0), "contract_leading (in memory), dense metric");
+    bool refused = false;
+    try
+    {
+        cAg.contract_leading(cB);
+    }
+    catch (const runtime_error&)
+    {
+        refused = true;
+    }
+    check(refused, "contract_leading (chunked) refuses a dense leading metric");
+
+    std::remove(a_path.c_str());
+    std::remove(b_path.c_str());
+    std::remove(out_path.c_str());
+}
+
+/// --------------------------------------------------------------------------------
+/// Tensor::contract : trace sur deux axes contre la somme sur les multi-indices
+/// --------------------------------------------------------------------------------
+
+static Tensor<double> naive_contract(const Tensor<double>& t, size_t axis1, size_t axis2)
+{
+    const vector<size_t>& shape = t.get_shape();
+    vector<size_t> rest;
+    for (size_t a = 0; a < shape.size(); ++a)
+        if (a != axis1 && a != axis2)
+            rest.push_back(shape[a]);
+    Tensor<double> r(rest, 0.0);
+    vector<size_t> idx(shape.size(), 0), out;
+    for (size_t i = 0; i < t.size(); ++i)
+    {
+        for (size_t a = shape.size(), q = i; a-- > 0; q /= shape[a])
+            idx[a] = q % shape[a];
+        if (idx[axis1] != idx[axis2])
+            continue;
+        out.clear();
+        for (size_t a = 0; a < shape.size(); ++a)
+            if (a != axis1 && a != axis2)
+                out.push_back(idx[a]);
+        r.at(out) += t.data()[i];
+    }
+    return r;
+}
+
+static void test_contract()
+{
+    for (const vector<size_t>& shape : vector<vector<size_t>>{{7, 7}, {3, 5, 3}, {4, 6, 4, 5}, {5, 2, 3, 5, 4}})
+        for (size_t a1 = 0; a1 < shape.size(); ++a1)
+            for (size_t a2 = 0; a2 < shape.size(); ++a2)
+                if (a1 != a2 && shape[a1] == shape[a2])
+                {
+                    Tensor<double> t = random_tensor(shape);
+                    check_close(t.contract(a1, a2), naive_contract(t, a1, a2),
+                                "contract(" + std::to_string(a1) + ", " + std::to_string(a2) + ") rank " + std::to_string(shape.size()));
+                }
+
+    // Assez grand pour être réparti sur le pool
+    Tensor<double> big = random_tensor({24, 30, 24, 31});
+    check_close(big.contract(0, 2), naive_contract(big, 0, 2), "contract(0, 2) 24x30x24x31", 1e-9);
+    check_close(big.contract(2, 0), naive_contract(big, 0, 2), "contract(2, 0) 24x30x24x31", 1e-9);
+}
+
+/// --------------------------------------------------------------------------------
+/// einsum : paires GEMM (avec lots), traces et diagonales, contre une somme directe
+/// --------------------------------------------------------------------------------
+
+// Somme directe sur toutes les lettres : sortie explicite, opérandes de rang quelconque
+static Tensor<double> naive_einsum(const vector<string>& inputs, const string& output, const vector<Tensor<double>>& ops)
+{
+    string letters;
+    size_t dim[128] = {0};
+    for (size_t o = 0; o < ops.size(); ++o)
+        for (size_t d = 0; d < inputs[o].size(); ++d)
+        {
+            char c = inputs[o][d];
+            if (letters.find(c) == string::npos)
+                letters += c;
+            dim[size_t(c)] = ops[o].get_shape()[d];
+        }
+    vector<size_t> out_shape;
+    for (char c : output)
+        out_shape.push_back(dim[size_t(c)]);
+    Tensor<double> r(out_shape, 0.0);
+
+    size_t total = 1;
+    for (char c : letters)
+        total *= dim[size_t(c)];
+    size_t value[128] = {0};
+    vector<size_t> idx;
+    for (size_t n = 0; n < total; ++n)
+    {
+        for (size_t l = letters.size(), q = n; l-- > 0; q /= dim[size_t(letters[l])])
+            value[size_t(letters[l])] = q % dim[size_t(letters[l])];
+        double prod = 1.0;
+        for (size_t o = 0; o < ops.size(); ++o)
+        {
+            idx.clear();
+            for (char c : inputs[o])
+                idx.push_back(value[size_t(c)]);
+            prod *= ops[o].at(idx);
+        }
+        idx.clear();
+        for (char c : output)
+            idx.push_back(value[size_t(c)]);
+        r.at(idx) += prod;
+    }
+    return r;
+}
+
+static void test_einsum()
+{
+    Tensor<double> A = random_tensor({5, 6}), B = random_tensor({6, 7}), C = random_tensor({7, 4});
+    Tensor<double> R = random_tensor({4, 5, 4, 3}), g = random_tensor({4, 4});
+    Tensor<double> v = random_tensor({6}), w = random_tensor({6});
+    Tensor<double> X = random_tensor({3, 4, 5}), Y = random_tensor({3, 5, 2}), D = random_tensor({3, 3, 6});
+
+    check_close(einsum("ij,jk->ik", A, B), naive_einsum({"ij", "jk"}, "ik", {A, B}), "matrix product");
+    check_close(einsum("ij,jk", A, B), naive_einsum({"ij", "jk"}, "ik", {A, B}), "implicit output");
+    check_close(einsum("ij,jk,kl->il", A, B, C), naive_einsum({"ij", "jk", "kl"}, "il", {A, B, C}), "chain of three");
+    check_close(einsum("ij,jk,kl->li", A, B, C), naive_einsum({"ij", "jk", "kl"}, "li", {A, B, C}), "chain, permuted output");
+    check_close(einsum("ij,jk->k", A, B), naive_einsum({"ij", "jk"}, "k", {A, B}), "index summed in one operand");
+    check_close(einsum("abcd,ac->bd", R, g), naive_einsum({"abcd", "ac"}, "bd", {R, g}), "two index pairs");
+    check_close(einsum("abad->bd", R), naive_einsum({"abad"}, "bd", {R}), "trace");
+    Tensor<double> E = random_tensor({6, 2});
+    check_close(einsum("iij,jk->ik", D, E), naive_einsum({"iij", "jk"}, "ik", {D, E}), "diagonal");
+    check_close(einsum("i,i->", v, w), naive_einsum({"i", "i"}, "", {v, w}), "dot product");
+    check_close(einsum("i,j->ij", v, w), naive_einsum({"i", "j"}, "ij", {v, w}), "outer product");
+    check_close(einsum("ij,ij->ij", A, A), naive_einsum({"ij", "ij"}, "ij", {A, A}), "element-wise product");
+    check_close(einsum("bij,bjk->bik", X, Y), naive_einsum({"bij", "bjk"}, "bik", {X, Y}), "batched product");
+    check_close(einsum("bij,bjk->kib", X, Y), naive_einsum({"bij", "bjk"}, "kib", {X, Y}), "batched product, permuted output");
+    check_close(einsum("ij->ji", A), naive_einsum({"ij"}, "ji", {A}), "transpose");
+
+    // Type générique (seulement + et *) : mêmes réductions et mêmes produits par paires
+    check_close(from_plain(einsum("ij,jk->ik", to_plain(A), to_plain(B))), naive_einsum({"ij", "jk"}, "ik", {A, B}), "matrix product, + and * only");
+    check_close(from_plain(einsum("ij,jk,kl->li", to_plain(A), to_plain(B), to_plain(C))), naive_einsum({"ij", "jk", "kl"}, "li", {A, B, C}),
+                "chain, + and * only");
+    check_close(from_plain(einsum("bij,bjk->bik", to_plain(X), to_plain(Y))), naive_einsum({"bij", "bjk"}, "bik", {X, Y}), "batched product, + and * only");
+    check_close(from_plain(einsum("abad->bd", to_plain(R))), naive_einsum({"abad"}, "bd", {R}), "trace, + and * only");
+
+    // Choix des paires : le produit extérieur (i, j, k, l) coûterait O(n^4)
+    Tensor<double> P = random_tensor({40, 40}), Q = random_tensor({40, 40}), S = random_tensor({40, 40});
+    check_close(einsum("ij,jk,kl->il", P, Q, S), P.contract_with(Q, 1, 0).contract_with(S, 1, 0), "chain of three 40x40", 1e-9);
+}
+
+/// --------------------------------------------------------------------------------
+/// KroneckerView : contraction sans construire K, contre le produit matérialisé
+/// --------------------------------------------------------------------------------
+
+static void test_kronecker()
+{
+    Tensor<double> A = random_tensor({2, 3}), B = random_tensor({4, 2});
+    KroneckerView<double> K(A, B);
+    Tensor<double> P = A.tensor_product(B);
+    check(K.get_shape() == P.get_shape(), "shape");
+    check_close(K.contiguous(), P, "contiguous");
+    bool same = true;
+    for (size_t i = 0; i < 8; ++i)
+        for (size_t j = 0; j < 6; ++j)
+            same = same && K(i, j) == A(i / 4, j / 2) * B(i % 4, j % 2) && K(i, j) == P(i, j);
+    check(same, "K(i, j) = A(i / dim_b, j / dim_b) * B(i % dim_b, j % dim_b)");
+
+    Tensor<double> X = random_tensor({6, 5}), Y = random_tensor({3, 8});
+    check_close(K.contract_with(X, 1, 0), P.contract_with(X, 1, 0), "contract axis 1");
+    check_close(K.contract_with(Y, 0, 1), P.contract_with(Y, 0, 1), "contract axis 0 with the last axis of X");
+
+    // Rangs différents : A complété par des axes de taille 1
+    Tensor<double> C = random_tensor({3}), D = random_tensor({2, 4, 2}), Z = random_tensor({2, 6, 3});
+    KroneckerView<double> KC(C, D);
+    Tensor<double> PC = C.tensor_product(D);
+    check_close(KC.contract_with(Z, 0, 1), PC.contract_with(Z, 0, 1), "ranks 1 and 3, axis 0");
+    check_close(KC.contract_with(Z, 2, 0), PC.contract_with(Z, 2, 0), "ranks 1 and 3, axis 2");
+
+    // Axe contracté de taille nulle : résultat nul, comme Tensor::contract_with
+    Tensor<double> E({2, 0}), F = random_tensor({2, 3}), W({0, 4});
+    Tensor<double> empty_sum = KroneckerView<double>(E, F).contract_with(W, 1, 0);
+    check(empty_sum.get_shape() == vector<size_t>({4, 4}), "empty axis: result shape");
+    check_close(empty_sum, E.tensor_product(F).contract_with(W, 1, 0), "empty axis: zero result");
+}
+
+/// --------------------------------------------------------------------------------
+/// Tranches avec pas et bornes négatives, take : contre une sélection élément par élément
+/// --------------------------------------------------------------------------------
+
+// Indices de range(start, end, step) en Python sur un axe de taille n
+static vector<size_t> python_range(size_t n, ptrdiff_t start, ptrdiff_t end, size_t step)
+{
+    ptrdiff_t len = static_cast<ptrdiff_t>(n);
+    auto bound = [len](ptrdiff_t i) { return i < 0 ? std::max<ptrdiff_t>(i + len, 0) : std::min(i, len); };
+    vector<size_t> picked;
+    for (ptrdiff_t i = bound(start); i < bound(end); i += static_cast<ptrdiff_t>(step))
+        picked.push_back(static_cast<size_t>(i));
+    return picked;
+}
+
+// Sous-tenseur des indices picked sur l'axe dim
+static Tensor<double> naive_select(const Tensor<double>& t, size_t dim, const vector<size_t>& picked)
+{
+    vector<size_t> shape = t.get_shape();
+    shape[dim] = picked.size();
+    Tensor<double> r(shape, 0.0);
+    vector<size_t> idx(shape.size(), 0), src;
+    for (size_t i = 0; i < r.size(); ++i)
+    {
+        for (size_t a = shape.size(), q = i; a-- > 0; q /= shape[a])
+            idx[a] = q % shape[a];
+        src = idx;
+        src[dim] = picked[idx[dim]];
+        r.at(idx) = t.at(src);
+    }
+    return r;
+}
+
+static void test_slice()
+{
+    const Tensor<double> T = random_tensor({5, 7, 6});
+
+    // (start, end, step) sur l'axe 1 (taille 7)
+    const vector<std::tuple<ptrdiff_t, ptrdiff_t, size_t>> ranges = {
+        {-3, 100, 1},   // a[-3:]
+        {-100, 100, 1}, // bornes hors de l'axe
+        {0, 7, 3},      // 3 éléments, 7 n'est pas multiple de 3
+        {1, 6, 4},
+        {-6, -1, 2},
+        {5, 2, 1},      // vides
+        {7, 100, 1},
+        {-1, -1, 1},
+    };
+    for (const auto& r : ranges)
+    {
+        ptrdiff_t start = std::get<0>(r), end = std::get<1>(r);
+        size_t step = std::get<2>(r);
+        string what = " [" + std::to_string(start) + ":" + std::to_string(end) + ":" + std::to_string(step) + "]";
+        vector<size_t> picked = python_range(7, start, end, step);
+        TensorView<const double> v = T.slice({{1, start, end, step}});
+        check(v.get_shape() == vector<size_t>({5, picked.size(), 6}), "shape" + what);
+        check_close(v.contiguous(), naive_select(T, 1, picked), "values" + what);
+    }
+
+    // Tranche vide d'une vue déjà décalée : l'offset ne bouge pas
+    TensorView<const double> rows = T.slice({{0, 1, 5, 1}});
+    for (ptrdiff_t start : {7, 3, -1})
+    {
+        TensorView<const double> empty = rows.slice({{1, start, 2, 1}});
+        check(empty.get_offset() == rows.get_offset() && empty.get_shape()[1] == 0 && empty.contiguous().size() == 0,
+              "empty slice keeps the offset (start " + std::to_string(start) + ")");
+    }
+
+    // Plusieurs axes à la fois, puis un pas nul refusé
+    check_close(T.slice({{0, -2, 100, 1}, {2, 0, 6, 4}}).contiguous(),
+                naive_select(naive_select(T, 0, {3, 4}), 2, {0, 4}), "two axes");
+    bool refused = false;
+    try
+    {
+        T.slice({{1, 0, 7, 0}});
+    }
+    catch (const runtime_error&)
+    {
+        refused = true;
+    }
+    check(refused, "step 0 refused");
+
+    // take sur l'axe du milieu, indices répétés et dans le désordre, sur le tenseur puis sur une vue à pas
+    check_close(T.take(1, {6, 0, 3, 3}), naive_select(T, 1, {6, 0, 3, 3}), "take, middle axis");
+    check_close(T.slice({{2, 1, 6, 2}}).take(1, {2, 5}), naive_select(naive_select(T, 2, {1, 3, 5}), 1, {2, 5}), "take on a strided view");
+
+    // slice -> permute -> contiguous
+    Tensor<double> S = naive_select(naive_select(T, 0, python_range(5, -4, 5, 2)), 1, python_range(7, 1, 7, 3));
+    Tensor<double> expected({S.get_shape()[2], S.get_shape()[0], S.get_shape()[1]});
+    for (size_t i = 0; i < S.get_shape()[0]; ++i)
+        for (size_t j = 0; j < S.get_shape()[1]; ++j)
+            for (size_t k = 0; k < S.get_shape()[2]; ++k)
+                expected(k, i, j) = S(i, j, k);
+    check_close(T.slice({{0, -4, 5, 2}, {1, 1, 7, 3}}).permute({2, 0, 1}).contiguous(), expected, "slice, permute, contiguous");
+}
+
+/// --------------------------------------------------------------------------------
+/// Fichiers .tns : save / load / mmap, pas non row-major, fichiers tronqués ou corrompus
+/// --------------------------------------------------------------------------------
+
+static vector<char> read_bytes(const string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static void write_bytes(const string& path, const vector<char>& bytes)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+// load et mmap doivent tous deux refuser le fichier par une runtime_error
+template<typename T>
+static bool rejected(const string& path)
+{
+    int refused = 0;
+    try
+    {
+        Tensor<T>::load(path);
+    }
+    catch (const runtime_error&)
+    {
+        ++refused;
+    }
+    catch (...)
+    {
+    }
+    try
+    {
+        Tensor<T>::mmap(path);
+    }
+    catch (const runtime_error&)
+    {
+        ++refused;
+    }
+    catch (...)
+    {
+    }
+    return refused == 2;
+}
+
+static void test_io()
+{
+    const string path = "tenseurs_test_io.tns", bad_path = "tenseurs_test_bad.tns";
+
+    // Données et bloc métrique
+    Tensor<double> A = random_tensor({4, 3, 5});
+    Tensor<double> G = random_tensor({5, 5});
+    A.set_metric(G);
+    A.save(path);
+    Tensor<double> L = Tensor<double>::load(path);
+    check_close(L, A, "load: values");
+    check(L.get_metric() && L.get_metric()->get_shape() == G.get_shape(), "load: metric shape");
+    if (L.get_metric())
+        check_close(*L.get_metric(), G, "load: metric values");
+
+    MappedTensor<const double> M = Tensor<double>::mmap(path);
+    check(M.get_shape() == A.get_shape() && M.is_contiguous(), "mmap: shape");
+    check_close(M.to_tensor(), L, "mmap matches load");
+    check(M(3, 2, 4) == A(3, 2, 4) && M(0, 1, 2) == A(0, 1, 2), "mmap: element access");
+    check(M.get_shared_metric() && M.get_shared_metric()->tensor().get_shape() == G.get_shape(), "mmap: metric");
+
+    // Copie à l'écriture : le fichier n'est pas modifié
+    {
+        MappedTensor<double> W = Tensor<double>::mmap_copy_on_write(path);
+        W(0, 0, 0) = A(0, 0, 0) + 1.0;
+        check(W(0, 0, 0) == A(0, 0, 0) + 1.0, "mmap_copy_on_write: write visible");
+    }
+    check_close(Tensor<double>::load(path), A, "mmap_copy_on_write leaves the file unchanged");
+
+    // Sans métrique
+    Tensor<double> B = random_tensor({7});
+    B.save(path);
+    check(!Tensor<double>::load(path).get_metric() && !Tensor<double>::mmap(path).get_shared_metric(), "no metric block");
+
+    // Pas colonne par colonne (écrits par un autre programme) : load remet le tenseur en row-major
+    vector<double> column_major(12);
+    for (size_t k = 0; k < column_major.size(); ++k)
+        column_major[k] = double(k);
+    tensor_io::write_file(path, column_major.data(), vector<size_t>{3, 4}, vector<size_t>{1, 3});
+    Tensor<double> C = Tensor<double>::load(path);
+    MappedTensor<const double> MC = Tensor<double>::mmap(path);
+    bool transposed = C.get_shape() == vector<size_t>({3, 4}) && C.get_strides() == vector<size_t>({4, 1}) && !MC.is_contiguous();
+    for (size_t i = 0; i < 3; ++i)
+        for (size_t j = 0; j < 4; ++j)
+            transposed = transposed && C(i, j) == double(i + 3 * j) && MC(i, j) == C(i, j);
+    check(transposed, "non row-major strides");
+    check_close(MC.to_tensor(), C, "non row-major: mmap matches load");
+
+    // Fichiers refusés
+    A.save(path);
+    const vector<char> good = read_bytes(path);
+    tensor_io::FileHeader h;
+    std::memcpy(&h, good.data(), sizeof(h));
+    check(!rejected<double>(path), "valid file accepted");
+
+    vector<char> bytes(good.begin(), good.begin() + static_cast<std::ptrdiff_t>(h.payload_offset + 8));
+    write_bytes(bad_path, bytes);
+    check(rejected<double>(bad_path), "truncated payload");
+
+    bytes.assign(good.begin(), good.begin() + 40);
+    write_bytes(bad_path, bytes);
+    check(rejected<double>(bad_path), "truncated header");
+
+    bytes = good;
+    bytes[0] = 'X';
+    write_bytes(bad_path, bytes);
+    check(rejected<double>(bad_path), "bad magic");
+
+    check(rejected<float>(path), "element type mismatch");
+
+    // count * sizeof(T) déborde : 2^61 éléments de 8 octets donnent 0, shape et strides cohérents avec count
+    Tensor<double> D = random_tensor({8});
+    D.save(path);
+    bytes = read_bytes(path);
+    tensor_io::FileHeader hd;
+    std::memcpy(&hd, bytes.data(), sizeof(hd));
+    uint64_t huge = uint64_t(1) << 61;
+    hd.count = huge;
+    std::memcpy(bytes.data(), &hd, sizeof(hd));
+    std::memcpy(bytes.data() + sizeof(hd), &huge, sizeof(huge));
+    write_bytes(bad_path, bytes);
+    check(rejected<double>(bad_path), "element count overflowing the payload size");
+
+    std::remove(path.c_str());
+    std::remove(bad_path.c_str());
+}
+
+/// --------------------------------------------------------------------------------
+/// Opérations par lots : chaque branche contre pseudo_norm / contract_with élément par élément
+/// --------------------------------------------------------------------------------
+
+// Élément b d'un tenseur contigu {N, ...}
+static Tensor<double> item(const Tensor<double>& t, size_t b)
+{
+    Tensor<double> r(vector<size_t>(t.get_shape().begin() + 1, t.get_shape().end()));
+    std::copy(t.data() + b * r.size(), t.data() + (b + 1) * r.size(), r.data());
+    return r;
+}
+
+// Tenseur {n, ...} dont l'élément b est f(b)
+static Tensor<double> stack_items(size_t n, const vector<size_t>& shape, const std::function<Tensor<double>(size_t)>& f)
+{
+    Tensor<double> r(shape);
+    size_t block = r.size() / n;
+    for (size_t b = 0; b < n; ++b)
+    {
+        Tensor<double> x = f(b);
+        std::copy(x.data(), x.data() + block, r.data() + b * block);
+    }
+    return r;
+}
+
+static void test_batched()
+{
+    const size_t N = 37;
+
+    // batched_pseudo_norm : sans métrique, identité, diagonale, symétrique, pleine ; d = 2, 3, 4 déroulés, d = 6 générique
+    for (size_t d : {2, 3, 4, 6})
+    {
+        string dim = " d = " + std::to_string(d);
+        Tensor<double> X = random_tensor({N, d}), dense = random_tensor({d, d}), identity({d, d}), symmetric({d, d});
+        identity.fill(0.0);
+        for (size_t i = 0; i < d; ++i)
+        {
+            identity(i, i) = 1.0;
+            for (size_t j = 0; j < d; ++j)
+                symmetric(i, j) = dense(i, j) + dense(j, i);
+        }
+        check_close(X.batched_pseudo_norm(), stack_items(N, {N}, [&](size_t b) { return Tensor<double>({1}, item(X, b).pseudo_norm()); }),
+                    "pseudo_norm, no metric" + dim);
+
+        const vector<std::tuple<string, Tensor<double>, MetricKind>> metrics = {
+            {"identity", identity, MetricKind::Identity},
+            {"diagonal", diagonal_metric(d), MetricKind::Diagonal},
+            {"symmetric", symmetric, MetricKind::Symmetric},
+            {"dense", dense, MetricKind::Dense},
+        };
+        for (const auto& m : metrics)
+        {
+            string what = "pseudo_norm, " + std::get<0>(m) + " metric" + dim;
+            shared_ptr<const Metric<double>> g = make_metric(std::get<1>(m));
+            check(g->get_kind() == std::get<2>(m), what + ": kind");
+            Tensor<double> expected = stack_items(N, {N}, [&](size_t b)
+            {
+                Tensor<double> v = item(X, b);
+                v.set_metric(g);
+                return Tensor<double>({1}, v.pseudo_norm());
+            });
+            check_close(X.batched_pseudo_norm(g), expected, what);
+            Tensor<double> Xg = X;
+            Xg.set_metric(g);
+            check_close(Xg.batched_pseudo_norm(), expected, what + ", tensor's own metric");
+        }
+    }
+
+    // batched_matvec : petite matrice partagée (m * d <= 64), grande matrice partagée (un GEMM), une matrice par vecteur
+    Tensor<double> V = random_tensor({N, 4}), W = random_tensor({N, 12});
+    Tensor<double> small = random_tensor({4, 4}), large = random_tensor({10, 12}), own = random_tensor({N, 3, 4});
+    check_close(V.batched_matvec(small), stack_items(N, {N, 4}, [&](size_t b) { return small.contract_with(item(V, b), 1, 0); }),
+                "matvec, small shared matrix");
+    check_close(W.batched_matvec(large), stack_items(N, {N, 10}, [&](size_t b) { return large.contract_with(item(W, b), 1, 0); }),
+                "matvec, large shared matrix");
+    check_close(V.batched_matvec(own), stack_items(N, {N, 3}, [&](size_t b) { return item(own, b).contract_with(item(V, b), 1, 0); }),
+                "matvec, one matrix per vector");
+
+    // batched_contract_with : opérandes déjà dans l'ordre ou permutés, sans métrique puis avec métrique diagonale et pleine
+    Tensor<double> A = random_tensor({N, 3, 5}), B = random_tensor({N, 5, 2});
+    Tensor<double> At = random_tensor({N, 5, 3}), Bt = random_tensor({N, 2, 5});
+    const vector<std::pair<string, Tensor<double>>> contraction_metrics = {
+        {"no metric", Tensor<double>()},
+        {"diagonal metric", diagonal_metric(5)},
+        {"dense metric", random_tensor({5, 5})},
+    };
+    for (const auto& m : contraction_metrics)
+    {
+        Tensor<double> Am = A, Atm = At;
+        if (m.second.size() > 1)
+        {
+            Am.set_metric(m.second);
+            Atm.set_metric(m.second);
+        }
+        auto per_item = [&](const Tensor<double>& a, const Tensor<double>& b, size_t axis_a, size_t axis_b)
+        {
+            return [&, axis_a, axis_b](size_t k)
+            {
+                Tensor<double> x = item(a, k);
+                if (m.second.size() > 1)
+                    x.set_metric(m.second);
+                return x.contract_with(item(b, k), axis_a, axis_b);
+            };
+        };
+        check_close(Am.batched_contract_with(B, 1, 0), stack_items(N, {N, 3, 2}, per_item(A, B, 1, 0)), "contract_with, " + m.first);
+        check_close(Atm.batched_contract_with(Bt, 0, 1), stack_items(N, {N, 3, 2}, per_item(At, Bt, 0, 1)), "contract_with, permuted, " + m.first);
+    }
+
+    // Type générique (seulement + et *) : mêmes résultats que double
+    check_close(from_plain(to_plain(V).batched_matvec(to_plain(small))), V.batched_matvec(small), "matvec, small shared matrix, + and * only");
+    check_close(from_plain(to_plain(W).batched_matvec(to_plain(large))), W.batched_matvec(large), "matvec, large shared matrix, + and * only");
+    check_close(from_plain(to_plain(V).batched_matvec(to_plain(own))), V.batched_matvec(own), "matvec, one matrix per vector, + and * only");
+    check_close(from_plain(to_plain(A).batched_contract_with(to_plain(B), 1, 0)), A.batched_contract_with(B, 1, 0), "contract_with, + and * only");
+    for (size_t d : {3, 6})
+    {
+        Tensor<double> X = random_tensor({N, d}), g = random_tensor({d, d});
+        Tensor<Plain> Xp = to_plain(X);
+        Xp.set_metric(to_plain(g));
+        X.set_metric(g);
+        check_close(from_plain(Xp.batched_pseudo_norm()), X.batched_pseudo_norm(), "pseudo_norm, + and * only, d = " + std::to_string(d));
+    }
+}
+
+/// --------------------------------------------------------------------------------
+/// Copies : buffer partagé avec TENSOR_COPY_ON_WRITE, copie indépendante après écriture
+/// --------------------------------------------------------------------------------
+
+static void test_copy()
+{
+    // random_tensor écrit par data() : son buffer n'est plus partageable, sa copie x l'est
+    Tensor<double> source = random_tensor({64});
+    Tensor<double> x = source;
+    Tensor<double> y = x;
+    Tensor<double> z;
+    z = x;
+    // Accès const : data() non const détacherait le buffer
+    const double* px = std::as_const(x).data();
+#if TENSOR_COPY_ON_WRITE
+    check(std::as_const(y).data() == px, "copy constructor shares the buffer");
+    check(std::as_const(z).data() == px, "copy assignment shares the buffer");
+#else
+    check(std::as_const(y).data() != px && std::as_const(z).data() != px, "copies own their buffer");
+#endif
+    double x0 = x(0);
+    y(0) = x0 + 1.0;
+    check(x(0) == x0 && y(0) == x0 + 1.0, "write to a copy leaves the source unchanged");
+    check(std::as_const(y).data() != std::as_const(x).data(), "written copy has its own buffer");
+    check_close(z, x, "untouched copy keeps the values");
+}
+
+int main(int argc, char** argv)
+{
+    string filter = argc > 1 ? argv[1] : "";
+    const std::vector<std::pair<string, std::function<void()>>> tests = {
+        {"broadcast", test_broadcast},
+        {"alloc", test_alloc},
+        {"sparse", test_sparse},
+        {"packed", test_packed},
+        {"riemann", test_riemann},
+        {"symbolic", test_symbolic},
+        {"chunked", test_chunked},
+        {"contract", test_contract},
+        {"einsum", test_einsum},
+        {"kronecker", test_kronecker},
+        {"slice", test_slice},
+        {"io", test_io},
+        {"batched", test_batched},
+        {"copy", test_copy},
+    };
+    for (const auto& t : tests)
+    {
+        if (!filter.empty() && t.first.find(filter) == string::npos)
+            continue;
+        current_test = t.first;
+        int before = failures;
+        t.second();
+        cout << (failures == before ? "ok    " : "FAILED ") << t.first << endl;
+    }
+    cout << checks << " checks, " << failures << " failures" << endl;
+    return failures ? 1 : 0;
+}